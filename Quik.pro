@@ -15,15 +15,32 @@ HEADERS += \
     include/Quik/QuikAPI.h \
     include/Quik/Quik.h \
     src/core/QuikContext.h \
+    src/core/MpscQueue.h \
+    src/core/QuikTrace.h \
+    src/core/LatencyHistogram.h \
+    src/core/QuikReplay.h \
     src/core/QuikViewModel.h \
+    src/core/AsyncComputed.h \
+    src/core/BatchEvaluator.h \
+    src/parser/Lexer.h \
     src/parser/ExpressionParser.h \
     src/parser/XMLUIBuilder.h \
-    src/widget/WidgetFactory.h
+    src/widget/WidgetFactory.h \
+    src/widget/WidgetAdapter.h \
+    src/widget/ProfileOverlay.h
 
 # Sources
 SOURCES += \
     src/core/QuikContext.cpp \
+    src/core/QuikTrace.cpp \
+    src/core/LatencyHistogram.cpp \
+    src/core/QuikReplay.cpp \
     src/core/QuikViewModel.cpp \
+    src/core/AsyncComputed.cpp \
+    src/core/BatchEvaluator.cpp \
+    src/parser/Lexer.cpp \
     src/parser/ExpressionParser.cpp \
     src/parser/XMLUIBuilder.cpp \
-    src/widget/WidgetFactory.cpp
+    src/widget/WidgetFactory.cpp \
+    src/widget/WidgetAdapter.cpp \
+    src/widget/ProfileOverlay.cpp
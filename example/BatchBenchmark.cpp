@@ -0,0 +1,64 @@
+#include "BatchBenchmark.h"
+#include "Quik/Quik.h"
+#include <QElapsedTimer>
+#include <QTextStream>
+
+namespace {
+
+const int RecordCount = 200000;
+
+} // anonymous namespace
+
+int runBatchBenchmark() {
+    using namespace Quik;
+
+    QTextStream out(stdout);
+    const QString expression = "$mode in [1, 3] and $level>=2.5 or $kind==Beta and not $locked==1";
+    CompiledExpression compiled = ExpressionParser::compile(expression);
+
+    // 固定种子的伪随机记录
+    QList<QVariantMap> records;
+    records.reserve(RecordCount);
+    const QStringList kinds = {"Alpha", "Beta", "Gamma"};
+    quint32 state = 2463534242u;
+    for (int i = 0; i < RecordCount; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        QVariantMap record;
+        record["mode"] = int(state % 5);
+        record["level"] = double(state % 1000) / 200.0;
+        record["kind"] = kinds.at(int(state >> 8) % kinds.size());
+        record["locked"] = int((state >> 4) & 1);
+        records.append(record);
+    }
+
+    out << "Batch benchmark (" << RecordCount << " records)\n" << expression << "\n";
+
+    QElapsedTimer timer;
+    timer.start();
+    int scalarCount = 0;
+    for (const QVariantMap& record : records) {
+        scalarCount += compiled.evaluate(record) ? 1 : 0;
+    }
+    qint64 scalarNs = timer.nsecsElapsed();
+
+    timer.restart();
+    BatchColumns columns = BatchColumns::fromRecords(records, compiled.variables());
+    qint64 convertNs = timer.nsecsElapsed();
+
+    timer.restart();
+    BatchMask mask = BatchEvaluator::evaluate(compiled, columns);
+    qint64 batchNs = timer.nsecsElapsed();
+
+    out << QString("%1 %2 ns/record\n").arg(QStringLiteral("QVariantMap"), -24).arg(double(scalarNs) / RecordCount, 8, 'f', 1);
+    out << QString("%1 %2 ns/record (once)\n").arg(QStringLiteral("columns from records"), -24).arg(double(convertNs) / RecordCount, 8, 'f', 1);
+    out << QString("%1 %2 ns/record  (x%3)\n").arg(QStringLiteral("BatchEvaluator"), -24)
+               .arg(double(batchNs) / RecordCount, 8, 'f', 1)
+               .arg(batchNs > 0 ? double(scalarNs) / batchNs : 0.0, 0, 'f', 1);
+    out << "matches: " << scalarCount << " / " << mask.count()
+        << (scalarCount == mask.count() ? "  (ok)\n" : "  (MISMATCH)\n");
+
+    out.flush();
+    return scalarCount == mask.count() ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#ifndef BATCHBENCHMARK_H
+#define BATCHBENCHMARK_H
+
+/**
+ * @brief 批量求值基准测试
+ *
+ * 生成 20 万条记录，对同一个复合表达式分别逐条用 QVariantMap 求值和用 BatchEvaluator 按列求值，
+ * 比较耗时并检查两者结果一致。
+ * 运行：QuikExample bench-batch
+ *
+ * @return 进程退出码，结果不一致时为1
+ */
+int runBatchBenchmark();
+
+#endif // BATCHBENCHMARK_H
@@ -0,0 +1,273 @@
+#include "FormGenerator.h"
+#include "Quik/Quik.h"
+#include <QElapsedTimer>
+#include <QTextStream>
+
+namespace {
+
+// 平台无关的随机数（xorshift32），保证相同种子生成相同的表单
+class Random {
+public:
+    explicit Random(quint32 seed) : m_state(seed ? seed : 0x9E3779B9u) {}
+
+    quint32 next() {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+    int bounded(int max) { return max > 0 ? int(next() % quint32(max)) : 0; }
+    double unit() { return next() / 4294967296.0; }
+
+private:
+    quint32 m_state;
+};
+
+class Generator {
+public:
+    explicit Generator(const FormGeneratorOptions& options)
+        : m_options(options)
+        , m_random(options.seed)
+    {
+        m_weights = options.tagWeights;
+        if (m_weights.isEmpty()) {
+            m_weights["LineEdit"] = 6;
+            m_weights["CheckBox"] = 4;
+            m_weights["ComboBox"] = 3;
+            m_weights["SpinBox"] = 3;
+            m_weights["DoubleSpinBox"] = 2;
+            m_weights["Label"] = 3;
+            m_weights["RadioButton"] = 1;
+            m_weights["PushButton"] = 1;
+            m_weights["Slider"] = 1;
+            m_weights["ProgressBar"] = 1;
+            m_weights["DateTimeEdit"] = 1;
+            m_weights["HLine"] = 1;
+        }
+        for (auto it = m_weights.constBegin(); it != m_weights.constEnd(); ++it) {
+            m_totalWeight += qMax(0, it.value());
+        }
+    }
+
+    GeneratedForm run() {
+        m_remaining = qMax(1, m_options.widgets);
+
+        m_xml += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+        m_xml += QString("<Panel title=\"Generated %1\">\n").arg(m_options.widgets);
+        emitDrivers();
+        emitQForBlocks();
+        while (m_remaining > 0) {
+            emitContainer(1, 1);
+        }
+        m_xml += "</Panel>\n";
+
+        m_form.xml = m_xml;
+        m_form.widgets = m_options.widgets - m_remaining;
+        return m_form;
+    }
+
+private:
+    QString indent(int depth) const { return QString(depth * 4, QLatin1Char(' ')); }
+
+    // 控制变量：CheckBox(0/1)、ComboBox(0~3)、SpinBox(0~10) 轮流
+    void emitDrivers() {
+        m_xml += "    <GroupBox title=\"Drivers\">\n";
+        for (int i = 0; i < qMax(1, m_options.drivers); ++i) {
+            QString name;
+            switch (i % 3) {
+            case 0:
+                name = QString("chk%1").arg(i);
+                m_xml += QString("        <CheckBox text=\"%1\" var=\"%1\"/>\n").arg(name);
+                break;
+            case 1:
+                name = QString("cmb%1").arg(i);
+                m_xml += QString("        <ComboBox title=\"%1\" var=\"%1\">\n").arg(name);
+                for (int c = 0; c < 4; ++c) {
+                    m_xml += QString("            <Choice text=\"Option %1\" val=\"%1\"/>\n").arg(c);
+                }
+                m_xml += "        </ComboBox>\n";
+                break;
+            default:
+                name = QString("spn%1").arg(i);
+                m_xml += QString("        <SpinBox title=\"%1\" var=\"%1\" min=\"0\" max=\"10\"/>\n").arg(name);
+                break;
+            }
+            m_form.drivers.append(name);
+            --m_remaining;
+        }
+        m_xml += "    </GroupBox>\n";
+        ++m_containers;
+        --m_remaining;
+    }
+
+    void emitQForBlocks() {
+        for (int block = 0; block < m_options.qForBlocks && m_remaining > 0; ++block) {
+            QString list = QString("list%1").arg(block);
+            QVariantList items;
+            for (int i = 0; i < m_options.qForItems; ++i) {
+                QVariantMap item;
+                item["label"] = QString("Item %1").arg(i);
+                item["value"] = i;
+                items.append(item);
+            }
+            m_form.listData[list] = items;
+
+            m_xml += QString("    <GroupBox title=\"%1\">\n").arg(list);
+            m_xml += QString("        <LineEdit q-for=\"(item, idx) in %1\" title=\"$item.label\" "
+                             "var=\"%1.$idx.value\"%2/>\n")
+                         .arg(list, attribute("visible", m_options.visibleDensity));
+            m_xml += "    </GroupBox>\n";
+            m_remaining -= 1 + m_options.qForItems;
+        }
+    }
+
+    void emitContainer(int depth, int xmlDepth) {
+        static const char* const containers[] = { "GroupBox", "VLayoutWidget", "HLayoutWidget" };
+        const QString tag = containers[m_random.bounded(3)];
+        const bool titled = tag == "GroupBox";
+        --m_remaining;
+        ++m_containers;
+
+        m_xml += indent(xmlDepth) + QString("<%1%2%3>\n")
+                     .arg(tag)
+                     .arg(titled ? QString(" title=\"Group %1\"").arg(m_containers) : QString())
+                     .arg(attribute("visible", m_options.visibleDensity / 2));
+
+        for (int i = 0; i < m_options.fanout && m_remaining > 0; ++i) {
+            if (depth < m_options.maxDepth && m_random.unit() < m_options.containerRatio) {
+                emitContainer(depth + 1, xmlDepth + 1);
+            } else {
+                emitLeaf(xmlDepth + 1);
+            }
+        }
+
+        m_xml += indent(xmlDepth) + QString("</%1>\n").arg(tag);
+    }
+
+    void emitLeaf(int xmlDepth) {
+        const QString tag = pickTag();
+        const QString name = QString("w%1").arg(++m_leaves);
+        QString attrs = QString(" var=\"%1\"").arg(name);
+
+        if (tag == "LineEdit" || tag == "ComboBox" || tag == "SpinBox" || tag == "DoubleSpinBox") {
+            attrs += QString(" title=\"Field %1\"").arg(m_leaves);
+        } else if (tag == "CheckBox" || tag == "RadioButton" || tag == "PushButton" || tag == "Label") {
+            attrs += QString(" text=\"Field %1\"").arg(m_leaves);
+        }
+        attrs += attribute("visible", m_options.visibleDensity);
+        attrs += attribute("enabled", m_options.enabledDensity);
+
+        if (tag == "ComboBox") {
+            m_xml += indent(xmlDepth) + QString("<ComboBox%1>\n").arg(attrs);
+            m_xml += indent(xmlDepth + 1) + "<Choice text=\"A\" val=\"a\"/>\n";
+            m_xml += indent(xmlDepth + 1) + "<Choice text=\"B\" val=\"b\"/>\n";
+            m_xml += indent(xmlDepth) + "</ComboBox>\n";
+        } else {
+            m_xml += indent(xmlDepth) + QString("<%1%2/>\n").arg(tag, attrs);
+        }
+        --m_remaining;
+    }
+
+    QString pickTag() {
+        int roll = m_random.bounded(m_totalWeight);
+        for (auto it = m_weights.constBegin(); it != m_weights.constEnd(); ++it) {
+            roll -= qMax(0, it.value());
+            if (roll < 0) return it.key();
+        }
+        return "LineEdit";
+    }
+
+    // 按密度生成 visible/enabled 属性，表达式由 1~n 个比较组成
+    QString attribute(const char* name, double density) {
+        if (m_random.unit() >= density) return QString();
+        ++m_form.bindings;
+        return QString(" %1=\"%2\"").arg(QString::fromLatin1(name), expression());
+    }
+
+    QString expression() {
+        const int count = 1 + m_random.bounded(qMax(1, m_options.conditionsPerExpression));
+        QString expr;
+        for (int i = 0; i < count; ++i) {
+            if (i > 0) expr += m_random.bounded(2) ? " and " : " or ";
+            const QString& driver = m_form.drivers.at(m_random.bounded(m_form.drivers.size()));
+            if (driver.startsWith("chk")) {
+                expr += QString("$%1==%2").arg(driver).arg(m_random.bounded(2));
+            } else if (driver.startsWith("cmb")) {
+                expr += QString("$%1%2%3").arg(driver, QString(m_random.bounded(2) ? "==" : "!=")).arg(m_random.bounded(4));
+            } else {
+                expr += QString("$%1%2%3").arg(driver, QString(m_random.bounded(2) ? "&gt;" : "&lt;=")).arg(m_random.bounded(11));
+            }
+        }
+        return expr;
+    }
+
+    FormGeneratorOptions m_options;
+    Random m_random;
+    QMap<QString, int> m_weights;
+    int m_totalWeight = 0;
+    int m_remaining = 0;
+    int m_containers = 0;
+    int m_leaves = 0;
+    QString m_xml;
+    GeneratedForm m_form;
+};
+
+} // anonymous namespace
+
+GeneratedForm generateForm(const FormGeneratorOptions& options) {
+    return Generator(options).run();
+}
+
+int runScaleBenchmark() {
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 %6\n")
+               .arg("widgets", 8).arg("bindings", 9).arg("build ms", 10)
+               .arg("toggle ms", 10).arg("memory KB", 10).arg("nodes", 7);
+
+    const int sizes[] = { 100, 1000, 10000, 50000 };
+    const int toggles = 20;
+
+    for (int size : sizes) {
+        FormGeneratorOptions options;
+        options.widgets = size;
+        options.qForItems = qMax(5, size / 100);
+        GeneratedForm form = generateForm(options);
+
+        Quik::XMLUIBuilder builder;
+        for (auto it = form.listData.constBegin(); it != form.listData.constEnd(); ++it) {
+            builder.setListData(it.key(), it.value());
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        QWidget* ui = builder.buildFromString(form.xml);
+        const double buildMs = timer.nsecsElapsed() / 1e6;
+        if (!ui) {
+            out << "build failed at " << size << " widgets\n";
+            return 1;
+        }
+
+        // 轮流切换控制变量，每次都会触发依赖它的绑定
+        timer.restart();
+        for (int i = 0; i < toggles; ++i) {
+            const QString& driver = form.drivers.at(i % form.drivers.size());
+            builder.setValue(driver, (i / form.drivers.size()) % 2 == 0 ? 1 : 0);
+        }
+        const double toggleMs = timer.nsecsElapsed() / 1e6 / toggles;
+
+        const Quik::MemoryStats memory = builder.memoryStats();
+        const Quik::BindingStats bindings = builder.context()->bindingStats();
+        out << QString("%1 %2 %3 %4 %5 %6\n")
+                   .arg(form.widgets, 8)
+                   .arg(bindings.bindings, 9)
+                   .arg(buildMs, 10, 'f', 1)
+                   .arg(toggleMs, 10, 'f', 3)
+                   .arg(memory.totalBytes() / 1024, 10)
+                   .arg(bindings.sharedExpressions, 7);
+        out.flush();
+
+        delete ui;
+    }
+    return 0;
+}
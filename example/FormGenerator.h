@@ -0,0 +1,72 @@
+#ifndef FORMGENERATOR_H
+#define FORMGENERATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QVariantList>
+
+/**
+ * @brief 合成表单生成参数
+ */
+struct FormGeneratorOptions {
+    int widgets = 1000;             // 目标组件数（按 XML 标签计，含容器和 q-for 渲染出的条目）
+    int maxDepth = 3;               // 容器最大嵌套深度
+    int fanout = 8;                 // 每个容器的子元素数
+    double containerRatio = 0.15;   // 子元素是容器的概率（未到最大深度时）
+    int drivers = 8;                // 控制变量数（CheckBox/ComboBox/SpinBox 轮流），表达式只引用它们
+    double visibleDensity = 0.3;    // 带 visible 表达式的组件比例
+    double enabledDensity = 0.1;    // 带 enabled 表达式的组件比例
+    int conditionsPerExpression = 2;    // 每个表达式的最多比较数（1~n，用 and/or 连接）
+    int qForBlocks = 2;             // q-for 块数
+    int qForItems = 20;             // 每个 q-for 数据源的条目数
+    quint32 seed = 1;               // 随机种子（相同参数和种子生成相同的表单）
+    
+    /**
+     * @brief 各叶子标签的权重，为空时使用默认分布（以输入组件为主）
+     */
+    QMap<QString, int> tagWeights;
+};
+
+/**
+ * @brief 生成结果
+ */
+struct GeneratedForm {
+    QString xml;                            // Quik XML
+    QMap<QString, QVariantList> listData;   // q-for 数据源，构建前通过 setListData 设置
+    QStringList drivers;                    // 控制变量名（切换它们会触发绑定）
+    int widgets = 0;                        // 实际生成的组件数
+    int bindings = 0;                       // visible/enabled 表达式数
+};
+
+/**
+ * @brief 生成合成的大型表单，用于在 100、1k、10k、50k 组件规模上测量优化效果
+ *
+ * 顶部是一组控制变量，其余组件分布在嵌套的 GroupBox/VLayoutWidget/HLayoutWidget 中，
+ * 按密度带有引用控制变量的 visible/enabled 表达式，另有若干 q-for 块及对应的数据源。
+ *
+ * 使用示例：
+ * @code
+ * FormGeneratorOptions options;
+ * options.widgets = 10000;
+ * GeneratedForm form = generateForm(options);
+ * Quik::XMLUIBuilder builder;
+ * for (auto it = form.listData.begin(); it != form.listData.end(); ++it) {
+ *     builder.setListData(it.key(), it.value());
+ * }
+ * QWidget* ui = builder.buildFromString(form.xml);
+ * @endcode
+ */
+GeneratedForm generateForm(const FormGeneratorOptions& options);
+
+/**
+ * @brief 规模基准测试：在各规模下测量构建耗时、切换控制变量的传播耗时和内存
+ *
+ * 运行：QuikExample bench-scale
+ * 导出表单：QuikExample gen-form <组件数> <输出文件>
+ *
+ * @return 进程退出码
+ */
+int runScaleBenchmark();
+
+#endif // FORMGENERATOR_H
@@ -0,0 +1,92 @@
+#include "HeadlessValidator.h"
+#include "Quik/Quik.h"
+#include <QFile>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct ValidationResult {
+    bool loaded = false;
+    int fields = 0;
+    int activeFields = 0;
+    QMap<QString, QString> errors;
+};
+
+ValidationResult validateFile(const QString& xml, const QString& jsonFile) {
+    ValidationResult result;
+    
+    Quik::XMLUIBuilder builder;
+    if (!builder.buildModel(xml) || !builder.loadFromJson(jsonFile)) {
+        return result;
+    }
+    result.loaded = true;
+    
+    Quik::QuikContext* context = builder.context();
+    for (const QString& field : context->fields()) {
+        ++result.fields;
+        if (context->isFieldActive(field)) {
+            ++result.activeFields;
+        }
+    }
+    result.errors = builder.getValidationErrors();
+    return result;
+}
+
+} // anonymous namespace
+
+int runHeadlessValidation(const QString& xmlPath, const QStringList& jsonFiles) {
+    QTextStream out(stdout);
+    
+    QFile file(xmlPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        out << "Cannot open " << xmlPath << "\n";
+        return 1;
+    }
+    const QString xml = QString::fromUtf8(file.readAll());
+    
+    // 按线程数分片，结果按文件顺序写回，无需加锁
+    const int count = jsonFiles.size();
+    const int threadCount = qMax(1, qMin(QThread::idealThreadCount(), count));
+    std::vector<ValidationResult> results(count);
+    std::vector<std::thread> threads;
+    
+    QElapsedTimer timer;
+    timer.start();
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = t; i < count; i += threadCount) {
+                results[i] = validateFile(xml, jsonFiles.at(i));
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    qint64 elapsedMs = timer.elapsed();
+    
+    int failed = 0;
+    for (int i = 0; i < count; ++i) {
+        const ValidationResult& result = results[i];
+        if (!result.loaded) {
+            out << jsonFiles.at(i) << ": load failed\n";
+            ++failed;
+            continue;
+        }
+        out << jsonFiles.at(i) << ": " << result.activeFields << "/" << result.fields << " fields active, "
+            << (result.errors.isEmpty() ? QString("valid") : QString("%1 errors").arg(result.errors.size())) << "\n";
+        for (auto it = result.errors.constBegin(); it != result.errors.constEnd(); ++it) {
+            out << "    " << it.key() << ": " << it.value() << "\n";
+        }
+        if (!result.errors.isEmpty()) {
+            ++failed;
+        }
+    }
+    out << count << " files on " << threadCount << " threads in " << elapsedMs << " ms, "
+        << failed << " failed\n";
+    
+    return failed == 0 ? 0 : 1;
+}
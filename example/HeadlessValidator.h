@@ -0,0 +1,20 @@
+#ifndef HEADLESSVALIDATOR_H
+#define HEADLESSVALIDATOR_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief 无界面批量校验
+ *
+ * 用 XMLUIBuilder::buildModel() 为每个参数文件构建一个不含组件的模型，
+ * 加载 JSON 后输出生效的字段数和校验错误。文件按线程数分片并行处理，每个线程使用各自的构建器。
+ * 运行：QuikExample validate <xml> <json>...
+ *
+ * @param xmlPath 界面 XML 文件
+ * @param jsonFiles 参数文件列表
+ * @return 进程退出码：全部通过为0，否则为1
+ */
+int runHeadlessValidation(const QString& xmlPath, const QStringList& jsonFiles);
+
+#endif // HEADLESSVALIDATOR_H
@@ -0,0 +1,82 @@
+#include "LayoutBenchmark.h"
+#include "Quik/Quik.h"
+#include <QApplication>
+#include <QDialog>
+#include <QVBoxLayout>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+namespace {
+
+const int RowCount = 50;
+const int Toggles = 100;
+
+// 两列面板，每列若干 GroupBox，共 RowCount 行由 $showRows 控制，另有一行由 $showOne 单独控制
+QString panelXml() {
+    QString xml = "<Panel title=\"Layout Benchmark\" width=\"700\" height=\"600\">\n"
+                  "    <CheckBox text=\"Show rows\" var=\"showRows\"/>\n"
+                  "    <CheckBox text=\"Show one\" var=\"showOne\"/>\n"
+                  "    <HLayoutWidget>\n";
+    int row = 0;
+    for (int column = 0; column < 2; ++column) {
+        xml += "        <VLayoutWidget>\n";
+        for (int group = 0; group < 5; ++group) {
+            xml += QString("            <GroupBox title=\"Group %1\">\n").arg(column * 5 + group);
+            if (column == 0 && group == 0) {
+                xml += "                <LineEdit title=\"Single\" var=\"single\" visible=\"$showOne==1\"/>\n";
+            }
+            for (int i = 0; i < RowCount / 10; ++i, ++row) {
+                xml += QString("                <LineEdit title=\"Row %1\" var=\"row%1\" visible=\"$showRows==1\"/>\n").arg(row);
+            }
+            xml += "            </GroupBox>\n";
+        }
+        xml += "        </VLayoutWidget>\n";
+    }
+    xml += "    </HLayoutWidget>\n</Panel>\n";
+    return xml;
+}
+
+// 每次切换 variable 后处理事件（布局请求、绘制），返回平均每帧耗时（微秒）
+double measure(bool batching, const QString& variable) {
+    QDialog dialog;
+    auto* layout = new QVBoxLayout(&dialog);
+    Quik::XMLUIBuilder builder;
+    QWidget* ui = builder.buildFromString(panelXml());
+    layout->addWidget(ui);
+    dialog.show();
+    QApplication::processEvents();
+
+    builder.context()->setLayoutBatching(batching);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < Toggles; ++i) {
+        builder.setValue(variable, i % 2 == 0 ? 1 : 0);
+        QApplication::processEvents();
+    }
+    return double(timer.nsecsElapsed()) / Toggles / 1000.0;
+}
+
+} // anonymous namespace
+
+int runLayoutBenchmark() {
+    QTextStream out(stdout);
+    out << "Layout benchmark (" << RowCount << " rows, " << Toggles << " toggles)\n";
+
+    // 同时切换 RowCount 行，以及只切换一行（批量只暂停变化行所在子树的重绘，不应比逐个慢）
+    const char* const variables[] = { "showRows", "showOne" };
+    const char* const labels[] = { "all rows", "single row" };
+    for (int v = 0; v < 2; ++v) {
+        const QString label = QString::fromLatin1(labels[v]);
+        double unbatched = measure(false, variables[v]);
+        double batched = measure(true, variables[v]);
+
+        out << QString("%1  per-widget layout   %2 us/frame\n").arg(label, -10).arg(unbatched, 8, 'f', 0);
+        out << QString("%1  batched layout      %2 us/frame  (x%3)\n")
+                   .arg(label, -10)
+                   .arg(batched, 8, 'f', 0)
+                   .arg(batched > 0 ? unbatched / batched : 0.0, 0, 'f', 1);
+    }
+    out.flush();
+    return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef LAYOUTBENCHMARK_H
+#define LAYOUTBENCHMARK_H
+
+/**
+ * @brief 布局批量基准测试
+ *
+ * 构建 AllWidgetsDemo.xml 规模的面板（两列 GroupBox，50 行由同一个变量控制显示，另有一行单独控制），
+ * 分别反复切换这两个变量，测量开启/关闭批量布局时每次切换到绘制完成的耗时。
+ * 运行：QuikExample bench-layout
+ *
+ * @return 进程退出码
+ */
+int runLayoutBenchmark();
+
+#endif // LAYOUTBENCHMARK_H
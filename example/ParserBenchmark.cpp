@@ -0,0 +1,148 @@
+#include "ParserBenchmark.h"
+#include "Quik/Quik.h"
+#include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <functional>
+
+namespace {
+
+// ========== 原实现（每次调用构造正则） ==========
+
+QStringList legacyExtractVariables(const QString& expr) {
+    QStringList vars;
+    QRegularExpression re("\\$([a-zA-Z_][a-zA-Z0-9_]*)");
+    QRegularExpressionMatchIterator it = re.globalMatch(expr);
+    while (it.hasNext()) {
+        QString varName = it.next().captured(1);
+        if (!vars.contains(varName)) vars.append(varName);
+    }
+    return vars;
+}
+
+QStringList legacySplitCompound(const QString& expr, QStringList& logicOps) {
+    QRegularExpression re("\\s+(and|or)\\s+", QRegularExpression::CaseInsensitiveOption);
+    QStringList parts = expr.trimmed().split(re);
+    QRegularExpressionMatchIterator it = re.globalMatch(expr.trimmed());
+    while (it.hasNext()) {
+        logicOps.append(it.next().captured(1).toLower());
+    }
+    return parts;
+}
+
+bool legacyParseQFor(const QString& qFor, QString& itemVar, QString& indexVar, QString& listName) {
+    QRegularExpression reWithIndex("\\(\\s*(\\w+)\\s*,\\s*(\\w+)\\s*\\)\\s+in\\s+(\\w+)");
+    QRegularExpressionMatch matchWithIndex = reWithIndex.match(qFor);
+    if (matchWithIndex.hasMatch()) {
+        itemVar = matchWithIndex.captured(1);
+        indexVar = matchWithIndex.captured(2);
+        listName = matchWithIndex.captured(3);
+        return true;
+    }
+    QRegularExpression reSimple("(\\w+)\\s+in\\s+(\\w+)");
+    QRegularExpressionMatch matchSimple = reSimple.match(qFor);
+    if (matchSimple.hasMatch()) {
+        itemVar = matchSimple.captured(1);
+        listName = matchSimple.captured(2);
+        return true;
+    }
+    return false;
+}
+
+QString legacyReplaceTemplateVars(const QString& str, int index, const QVariantMap& itemData,
+                                  const QString& itemVar, const QString& indexVar) {
+    QString result = str;
+    result.replace(QString("$%1").arg(indexVar), QString::number(index));
+    for (auto it = itemData.begin(); it != itemData.end(); ++it) {
+        result.replace(QString("$%1.%2").arg(itemVar).arg(it.key()), it.value().toString());
+    }
+    QRegularExpression varPattern(QString("var\\s*=\\s*\"([^\"]*\\$%1[^\"]*)\"").arg(indexVar));
+    QRegularExpressionMatchIterator matches = varPattern.globalMatch(result);
+    while (matches.hasNext()) {
+        QRegularExpressionMatch match = matches.next();
+        QString varValue = match.captured(1);
+        result.replace(match.captured(0),
+                       QString("var=\"%1\"").arg(varValue.replace(QString("$%1").arg(indexVar), QString::number(index))));
+    }
+    return result;
+}
+
+// ========== 计时 ==========
+
+void report(QTextStream& out, const QString& name, int iterations,
+            const std::function<void()>& legacy, const std::function<void()>& current) {
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int i = 0; i < iterations; ++i) legacy();
+    qint64 legacyNs = timer.nsecsElapsed();
+
+    timer.restart();
+    for (int i = 0; i < iterations; ++i) current();
+    qint64 currentNs = timer.nsecsElapsed();
+
+    out << QString("%1 %2 ns/op  ->  %3 ns/op  (x%4)\n")
+               .arg(name, -24)
+               .arg(legacyNs / iterations, 8)
+               .arg(currentNs / iterations, 8)
+               .arg(currentNs > 0 ? double(legacyNs) / currentNs : 0.0, 0, 'f', 1);
+}
+
+} // anonymous namespace
+
+int runParserBenchmark() {
+    using Quik::ExpressionParser;
+
+    QTextStream out(stdout);
+    const int iterations = 20000;
+
+    const QString guard = "$cmbType==1 and $chkAdvanced==1 or $mode==Expert and $level>=3";
+    const QString qFor = "(item, idx) in configs";
+    const QString tpl = "<LineEdit title=\"$item.label\" var=\"formData.$idx.name\" visible=\"$cmbType==$idx\"/>";
+    QVariantMap item;
+    item["label"] = "Name";
+    item["value"] = "name";
+
+    out << "Parser benchmark (" << iterations << " iterations, regex -> lexer)\n";
+
+    volatile int sink = 0;
+
+    report(out, "extractVariables", iterations,
+           [&]() { sink += legacyExtractVariables(guard).size(); },
+           [&]() { sink += ExpressionParser::extractVariables(guard).size(); });
+
+    report(out, "parseCompound", iterations,
+           [&]() {
+               QStringList ops;
+               for (const QString& part : legacySplitCompound(guard, ops)) {
+                   sink += ExpressionParser::parse(part.trimmed()).isValid;
+               }
+           },
+           [&]() { sink += ExpressionParser::parseCompound(guard).conditions.size(); });
+
+    report(out, "q-for", iterations,
+           [&]() { QString a, b, c; sink += legacyParseQFor(qFor, a, b, c); },
+           [&]() { sink += ExpressionParser::parseQFor(qFor).isValid; });
+
+    report(out, "replaceTemplateVars", iterations,
+           [&]() { sink += legacyReplaceTemplateVars(tpl, 3, item, "item", "idx").size(); },
+           [&]() { sink += ExpressionParser::substituteTemplate(tpl, "item", item, "idx", 3).size(); });
+
+    Quik::CompiledTemplate compiledTpl = ExpressionParser::compileTemplate(tpl);
+    Quik::TemplateScope scope;
+    scope.itemVar = "item";
+    scope.item = item;
+    scope.indexVar = "idx";
+    scope.index = 3;
+    const QVector<Quik::TemplateScope> scopes(1, scope);
+    report(out, "template (compiled)", iterations,
+           [&]() { sink += ExpressionParser::substituteTemplate(tpl, "item", item, "idx", 3).size(); },
+           [&]() { sink += compiledTpl.render(scopes).size(); });
+    
+    report(out, "split + extract (1 pass)", iterations,
+           [&]() { QStringList ops; sink += legacySplitCompound(guard, ops).size() + legacyExtractVariables(guard).size(); },
+           [&]() { sink += Quik::Lexer::tokenize(guard).size(); });
+
+    out.flush();
+    return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef PARSERBENCHMARK_H
+#define PARSERBENCHMARK_H
+
+/**
+ * @brief 解析器基准测试
+ *
+ * 对比基于 Lexer 的实现与原来每次调用都构造 QRegularExpression 的实现：
+ * 变量提取、复合条件分割、q-for 解析、模板替换。
+ * 运行：QuikExample bench-parser
+ *
+ * @return 进程退出码
+ */
+int runParserBenchmark();
+
+#endif // PARSERBENCHMARK_H
@@ -17,19 +17,46 @@ HEADERS += \
     $$PWD/../include/Quik/QuikAPI.h \
     $$PWD/../include/Quik/Quik.h \
     $$PWD/../src/core/QuikContext.h \
+    $$PWD/../src/core/MpscQueue.h \
+    $$PWD/../src/core/QuikTrace.h \
+    $$PWD/../src/core/LatencyHistogram.h \
+    $$PWD/../src/core/QuikReplay.h \
     $$PWD/../src/core/QuikViewModel.h \
+    $$PWD/../src/core/AsyncComputed.h \
+    $$PWD/../src/core/BatchEvaluator.h \
+    $$PWD/../src/parser/Lexer.h \
     $$PWD/../src/parser/ExpressionParser.h \
     $$PWD/../src/parser/XMLUIBuilder.h \
     $$PWD/../src/widget/WidgetFactory.h \
-    AllWidgetsNative.h
+    $$PWD/../src/widget/WidgetAdapter.h \
+    $$PWD/../src/widget/ProfileOverlay.h \
+    AllWidgetsNative.h \
+    ParserBenchmark.h \
+    LayoutBenchmark.h \
+    FormGenerator.h \
+    HeadlessValidator.h \
+    BatchBenchmark.h
 
 SOURCES += \
     main.cpp \
     AllWidgetsNative.cpp \
+    ParserBenchmark.cpp \
+    LayoutBenchmark.cpp \
+    FormGenerator.cpp \
+    HeadlessValidator.cpp \
+    BatchBenchmark.cpp \
     $$PWD/../src/core/QuikContext.cpp \
+    $$PWD/../src/core/QuikTrace.cpp \
+    $$PWD/../src/core/LatencyHistogram.cpp \
+    $$PWD/../src/core/QuikReplay.cpp \
     $$PWD/../src/core/QuikViewModel.cpp \
+    $$PWD/../src/core/AsyncComputed.cpp \
+    $$PWD/../src/core/BatchEvaluator.cpp \
+    $$PWD/../src/parser/Lexer.cpp \
     $$PWD/../src/parser/ExpressionParser.cpp \
     $$PWD/../src/parser/XMLUIBuilder.cpp \
-    $$PWD/../src/widget/WidgetFactory.cpp
+    $$PWD/../src/widget/WidgetFactory.cpp \
+    $$PWD/../src/widget/WidgetAdapter.cpp \
+    $$PWD/../src/widget/ProfileOverlay.cpp
 
 RESOURCES += resources.qrc
@@ -5,14 +5,29 @@
 #include <QTimer>
 #include <QFile>
 #include <QMessageBox>
+#include <QTextStream>
 #include "Quik/Quik.h"
 #include "AllWidgetsNative.h"
+#include "ParserBenchmark.h"
+#include "LayoutBenchmark.h"
+#include "FormGenerator.h"
+#include "HeadlessValidator.h"
+#include "BatchBenchmark.h"
 
 // 运行模式：
 // 无参数或 "example" - 运行原有示例
 // "gallery" - 运行Quik版Widget Gallery
 // "native" - 运行原生QWidget版Widget Gallery
 // "compare" - 同时显示两个版本进行对比
+// "bench-parser" - 解析器基准测试（正则实现 vs Lexer）
+// "bench-layout" - 批量布局基准测试（逐个 setVisible vs 批量）
+// "bench-scale" - 规模基准测试（100/1k/10k/50k 组件的合成表单）
+// "bench-batch" - 批量求值基准测试（逐条 QVariantMap vs 按列向量化）
+// "gen-form <组件数> <输出文件>" - 导出合成表单 XML
+// "replay <xml> <记录文件> [original]" - 用不显示的界面回放记录的操作并输出性能报告
+// "validate <xml> <json>..." - 不创建界面，多线程校验参数文件
+//
+// 设置环境变量 QUIK_RECORD=<文件> 运行原有示例时会记录变量变化，供 replay 使用
 
 int main(int argc, char *argv[])
 {
@@ -27,6 +42,84 @@ int main(int argc, char *argv[])
     
     QString mode = (argc > 1) ? QString(argv[1]) : "example";
     
+    // ========== 基准测试 ==========
+    if (mode == "bench-parser") {
+        return runParserBenchmark();
+    }
+    if (mode == "bench-layout") {
+        return runLayoutBenchmark();
+    }
+    if (mode == "bench-scale") {
+        return runScaleBenchmark();
+    }
+    if (mode == "bench-batch") {
+        return runBatchBenchmark();
+    }
+    if (mode == "gen-form") {
+        if (argc < 4) {
+            qWarning() << "Usage: QuikExample gen-form <widgets> <output.xml>";
+            return 1;
+        }
+        FormGeneratorOptions options;
+        options.widgets = QString(argv[2]).toInt();
+        GeneratedForm form = generateForm(options);
+        QFile file(QString::fromLocal8Bit(argv[3]));
+        if (!file.open(QFile::WriteOnly | QFile::Text)) {
+            qWarning() << "Cannot write" << argv[3];
+            return 1;
+        }
+        file.write(form.xml.toUtf8());
+        qDebug() << "Generated" << form.widgets << "widgets," << form.bindings << "bindings,"
+                 << form.listData.size() << "q-for lists (set with setListData before building)";
+        return 0;
+    }
+    
+    // ========== 无界面校验 ==========
+    if (mode == "validate") {
+        if (argc < 4) {
+            qWarning() << "Usage: QuikExample validate <xml> <json>...";
+            return 1;
+        }
+        QStringList jsonFiles;
+        for (int i = 3; i < argc; ++i) {
+            jsonFiles << QString::fromLocal8Bit(argv[i]);
+        }
+        return runHeadlessValidation(QString::fromLocal8Bit(argv[2]), jsonFiles);
+    }
+    
+    // ========== 回放 ==========
+    if (mode == "replay") {
+        if (argc < 4) {
+            qWarning() << "Usage: QuikExample replay <xml> <recording> [original]";
+            return 1;
+        }
+        Quik::XMLUIBuilder builder;
+        if (!builder.buildFromFile(QString::fromLocal8Bit(argv[2]))) {
+            return 1;
+        }
+        Quik::QuikReplayer replayer(builder.context());
+        if (!replayer.load(QString::fromLocal8Bit(argv[3]))) {
+            return 1;
+        }
+        
+        bool original = argc > 4 && QString(argv[4]) == "original";
+        if (original) {
+            QObject::connect(&replayer, &Quik::QuikReplayer::finished, &app, &QApplication::quit);
+            replayer.start(Quik::QuikReplayer::OriginalSpeed);
+            app.exec();
+        } else {
+            replayer.start(Quik::QuikReplayer::MaximumSpeed);
+        }
+        
+        Quik::ProfileReport report = replayer.profile();
+        report.sortBy(Quik::ProfileReport::ByTotalTime);
+        QTextStream out(stdout);
+        out << replayer.eventCount() << " events (recorded " << replayer.durationMs()
+            << " ms) replayed in " << replayer.elapsedMs() << " ms\n";
+        out << report.toString(20);
+        return 0;
+    }
+    
     // ========== Widget Gallery 对比模式 ==========
     if (mode == "gallery") {
         // Quik XML版本
@@ -78,6 +171,11 @@ int main(int argc, char *argv[])
     QWidget* ui = Quik_BUILD(builder, "ExamplePanel.xml");
     layout->addWidget(ui);
     
+    // 记录操作序列，之后可用 replay 模式复现
+    if (qEnvironmentVariableIsSet("QUIK_RECORD")) {
+        builder.context()->startRecording(QString::fromLocal8Bit(qgetenv("QUIK_RECORD")));
+    }
+    
     // Create ViewModel
     Quik::QuikViewModel vm(&builder);
     
@@ -109,11 +207,12 @@ int main(int argc, char *argv[])
         qDebug() << "cboMode changed:" << v;
     });
     
-    // 监听滑块变化，同步更新进度条
-    volume.watch([&](int v) {
+    // 监听滑块变化，同步更新进度条（QUIK_WATCH 记录注册位置，超出预算时可定位到这里）
+    builder.context()->setWatcherBudget(8);
+    QUIK_WATCH(volume.watch([&](int v) {
         qDebug() << "volume changed:" << v;
         progress = v;
-    });
+    }));
     
     // ========== 测试 watch 多个变量 ==========
     vm.watch({chkEnable, cboMode, spnCount}, [&]() {
@@ -53,10 +53,18 @@
  */
 
 #include "Quik/QuikAPI.h"
+#include "parser/Lexer.h"
 #include "parser/ExpressionParser.h"
+#include "core/QuikTrace.h"
+#include "core/LatencyHistogram.h"
 #include "core/QuikContext.h"
+#include "core/BatchEvaluator.h"
+#include "core/QuikReplay.h"
+#include "widget/WidgetAdapter.h"
 #include "widget/WidgetFactory.h"
+#include "widget/ProfileOverlay.h"
 #include "parser/XMLUIBuilder.h"
+#include "core/AsyncComputed.h"
 #include "core/QuikViewModel.h"
 #include <QFileInfo>
 #include <QFile>
@@ -0,0 +1,138 @@
+#include "AsyncComputed.h"
+#include "parser/XMLUIBuilder.h"
+#include "QuikContext.h"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace Quik {
+
+namespace {
+
+// 线程池任务：计算并把结果交回GUI线程
+class AsyncComputeJob : public QRunnable {
+public:
+    AsyncComputeJob(AsyncComputeFunction compute, const QVariantMap& inputs, const CancelToken& token,
+                    std::function<void(const QVariant&)> deliver)
+        : m_compute(compute), m_inputs(inputs), m_token(token), m_deliver(deliver) {}
+
+    void run() override {
+        // 排队期间已被取代的任务直接跳过计算
+        QVariant result;
+        if (!m_token.isCancelled()) {
+            result = m_compute(m_inputs, m_token);
+        }
+        m_deliver(result);
+    }
+
+private:
+    AsyncComputeFunction m_compute;
+    QVariantMap m_inputs;
+    CancelToken m_token;
+    std::function<void(const QVariant&)> m_deliver;
+};
+
+} // anonymous namespace
+
+AsyncComputed::AsyncComputed(XMLUIBuilder* builder, const QString& output, const QStringList& inputs,
+                             AsyncComputeFunction compute, QThreadPool* pool)
+    : QObject(builder)
+    , m_builder(builder)
+    , m_output(output)
+    , m_inputs(inputs)
+    , m_compute(compute)
+    , m_pool(pool ? pool : QThreadPool::globalInstance())
+    , m_shared(std::make_shared<Shared>())
+{
+    m_shared->owner = this;
+
+    connectContext();
+
+    // 热更新会重建 Context，需要重新连接并按新状态计算
+    connect(builder, &XMLUIBuilder::reloaded, this, [this]() {
+        connectContext();
+        recompute();
+    });
+
+    qDebug() << "[Quik] Async computed:" << output << "from" << inputs;
+
+    // 初始计算
+    recompute();
+}
+
+AsyncComputed::~AsyncComputed() {
+    m_currentToken.cancel();
+
+    // 运行中的任务结束后不再回调已销毁的对象
+    QMutexLocker locker(&m_shared->mutex);
+    m_shared->owner = nullptr;
+}
+
+void AsyncComputed::connectContext() {
+    disconnect(m_contextConnection);
+    m_contextConnection = connect(m_builder->context(), &QuikContext::variableChanged,
+                                  this, &AsyncComputed::onVariableChanged);
+}
+
+void AsyncComputed::onVariableChanged(const QString& name, const QVariant& value) {
+    Q_UNUSED(value)
+    if (m_inputs.contains(name)) {
+        recompute();
+    }
+}
+
+void AsyncComputed::recompute() {
+    ++m_generation;
+
+    // 已有任务运行：取消它并记录待计算，结束后用最新输入重算一次
+    if (m_running) {
+        if (!m_pending) {
+            m_currentToken.cancel();
+            m_pending = true;
+            ++m_superseded;
+        }
+        return;
+    }
+
+    startJob();
+}
+
+void AsyncComputed::startJob() {
+    // 在GUI线程中拍摄输入快照，任务只读快照
+    QVariantMap inputs;
+    for (const QString& name : m_inputs) {
+        inputs[name] = m_builder->getValue(name);
+    }
+
+    m_currentToken = CancelToken();
+    m_running = true;
+
+    quint64 generation = m_generation;
+    std::shared_ptr<Shared> shared = m_shared;
+    auto deliver = [shared, generation](const QVariant& result) {
+        QMutexLocker locker(&shared->mutex);
+        if (shared->owner) {
+            QMetaObject::invokeMethod(shared->owner, "onJobFinished", Qt::QueuedConnection,
+                                      Q_ARG(quint64, generation), Q_ARG(QVariant, result));
+        }
+    };
+
+    m_pool->start(new AsyncComputeJob(m_compute, inputs, m_currentToken, deliver));
+}
+
+void AsyncComputed::onJobFinished(quint64 generation, const QVariant& result) {
+    m_running = false;
+
+    // 只应用最新一代输入的结果
+    if (generation == m_generation && !m_pending) {
+        m_builder->setValue(m_output, result);
+    }
+
+    if (m_pending) {
+        m_pending = false;
+        startJob();
+    }
+}
+
+} // namespace Quik
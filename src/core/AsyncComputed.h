@@ -0,0 +1,127 @@
+#ifndef ASYNCCOMPUTED_H
+#define ASYNCCOMPUTED_H
+
+#include "Quik/QuikAPI.h"
+#include <QObject>
+#include <QVariantMap>
+#include <QStringList>
+#include <QMutex>
+#include <QMetaObject>
+#include <atomic>
+#include <memory>
+#include <functional>
+
+class QThreadPool;
+
+namespace Quik {
+
+class XMLUIBuilder;
+
+/**
+ * @brief 异步计算的取消标记
+ *
+ * 输入再次变化时标记被置位，计算函数可在循环中轮询以尽早退出。
+ */
+class QUIK_API CancelToken {
+public:
+    CancelToken() : m_flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+    /**
+     * @brief 是否已被新的输入变化取代
+     */
+    bool isCancelled() const { return m_flag->load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 取消（由 AsyncComputed 调用）
+     */
+    void cancel() const { m_flag->store(true, std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+/**
+ * @brief 异步计算函数类型
+ * @param inputs 输入变量快照（变量名 → 值）
+ * @param token 取消标记
+ * @return 计算结果，写回输出变量
+ */
+using AsyncComputeFunction = std::function<QVariant(const QVariantMap& inputs, const CancelToken& token)>;
+
+/**
+ * @brief 异步计算值
+ *
+ * 输出变量由一组输入变量经线程池中的函数计算得到：
+ * - 同一时刻最多一个任务在运行，运行期间的输入变化只记录为"待计算"并取消当前任务
+ * - 当前任务结束后用最新输入重新计算一次，拖动滑块不会堆积过期任务
+ * - 只有最新一代输入的结果才会通过 setValue 写回
+ *
+ * 由 QuikViewModel::computeAsync 创建，归 XMLUIBuilder 所有。
+ */
+class QUIK_API AsyncComputed : public QObject {
+    Q_OBJECT
+
+public:
+    AsyncComputed(XMLUIBuilder* builder, const QString& output, const QStringList& inputs,
+                  AsyncComputeFunction compute, QThreadPool* pool = nullptr);
+    ~AsyncComputed();
+
+    /**
+     * @brief 输出变量名
+     */
+    QString output() const { return m_output; }
+
+    /**
+     * @brief 输入变量名列表
+     */
+    QStringList inputs() const { return m_inputs; }
+
+    /**
+     * @brief 是否有任务正在运行
+     */
+    bool isRunning() const { return m_running; }
+
+    /**
+     * @brief 已被取代而丢弃的任务数（含被取消的和结果过期的）
+     */
+    int supersededCount() const { return m_superseded; }
+
+    /**
+     * @brief 立即按当前输入重新计算
+     */
+    void recompute();
+
+private slots:
+    void onVariableChanged(const QString& name, const QVariant& value);
+    void onJobFinished(quint64 generation, const QVariant& result);
+    void connectContext();
+
+private:
+    void startJob();
+
+    /**
+     * @brief 任务与对象之间共享的状态（对象销毁后任务不再回调）
+     */
+    struct Shared {
+        QMutex mutex;
+        AsyncComputed* owner;
+    };
+
+    XMLUIBuilder* m_builder;
+    QString m_output;
+    QStringList m_inputs;
+    AsyncComputeFunction m_compute;
+    QThreadPool* m_pool;
+
+    std::shared_ptr<Shared> m_shared;
+    QMetaObject::Connection m_contextConnection;
+    CancelToken m_currentToken;     // 运行中任务的取消标记
+    quint64 m_generation = 0;       // 输入代数，每次触发递增
+    bool m_running = false;
+    bool m_pending = false;         // 运行期间输入又发生变化
+    int m_superseded = 0;
+};
+
+} // namespace Quik
+
+#endif // ASYNCCOMPUTED_H
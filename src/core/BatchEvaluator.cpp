@@ -0,0 +1,551 @@
+#include "BatchEvaluator.h"
+#include "core/QuikContext.h"
+#include <QtAlgorithms>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace Quik {
+
+namespace {
+
+// 每块的行数（64 的倍数，块内字节数组常驻 L1/L2）
+const int BlockRows = 4096;
+
+const double Missing = std::numeric_limits<double>::quiet_NaN();
+
+// 与 qFuzzyCompare 一致，另外两个0相等；NaN（缺失）不等于任何值
+inline quint8 fuzzyEqual(double a, double b) {
+    return quint8(a == b) | quint8(std::abs(a - b) * 1000000000000. <= std::min(std::abs(a), std::abs(b)));
+}
+
+inline quint8 present(double a) {
+    return quint8(a == a);
+}
+
+// 每个运算符一个无分支循环，right(i) 是常量或另一列
+template<typename Right>
+void compareNumbers(CompareOp op, const double* left, Right right, int count, quint8* out) {
+    switch (op) {
+    case CompareOp::Equal:
+        for (int i = 0; i < count; ++i) out[i] = fuzzyEqual(left[i], right(i));
+        return;
+    case CompareOp::NotEqual:
+        for (int i = 0; i < count; ++i) {
+            out[i] = present(left[i]) & present(right(i)) & (fuzzyEqual(left[i], right(i)) ^ 1);
+        }
+        return;
+    case CompareOp::Greater:
+        for (int i = 0; i < count; ++i) out[i] = quint8(left[i] > right(i));
+        return;
+    case CompareOp::Less:
+        for (int i = 0; i < count; ++i) out[i] = quint8(left[i] < right(i));
+        return;
+    case CompareOp::GreaterEqual:
+        for (int i = 0; i < count; ++i) out[i] = quint8(left[i] >= right(i));
+        return;
+    case CompareOp::LessEqual:
+        for (int i = 0; i < count; ++i) out[i] = quint8(left[i] <= right(i));
+        return;
+    case CompareOp::In:
+    case CompareOp::NotIn:
+    case CompareOp::Invalid:
+        break;
+    }
+    std::fill(out, out + count, quint8(0));
+}
+
+// 整数列与整数常量：与逐行求值的 qint64 比较一致，缺失的行（numbers 为 NaN）为假
+void compareIntegers(CompareOp op, const qint64* left, const double* numbers, qint64 right, int count, quint8* out) {
+    switch (op) {
+    case CompareOp::Equal:
+        for (int i = 0; i < count; ++i) out[i] = present(numbers[i]) & quint8(left[i] == right);
+        return;
+    case CompareOp::NotEqual:
+        for (int i = 0; i < count; ++i) out[i] = present(numbers[i]) & quint8(left[i] != right);
+        return;
+    case CompareOp::Greater:
+        for (int i = 0; i < count; ++i) out[i] = present(numbers[i]) & quint8(left[i] > right);
+        return;
+    case CompareOp::Less:
+        for (int i = 0; i < count; ++i) out[i] = present(numbers[i]) & quint8(left[i] < right);
+        return;
+    case CompareOp::GreaterEqual:
+        for (int i = 0; i < count; ++i) out[i] = present(numbers[i]) & quint8(left[i] >= right);
+        return;
+    case CompareOp::LessEqual:
+        for (int i = 0; i < count; ++i) out[i] = present(numbers[i]) & quint8(left[i] <= right);
+        return;
+    case CompareOp::In:
+    case CompareOp::NotIn:
+    case CompareOp::Invalid:
+        break;
+    }
+    std::fill(out, out + count, quint8(0));
+}
+
+bool anySet(const quint8* bytes, int count) {
+    quint8 any = 0;
+    for (int i = 0; i < count; ++i) any |= bytes[i];
+    return any != 0;
+}
+
+bool allSet(const quint8* bytes, int count) {
+    quint8 all = 1;
+    for (int i = 0; i < count; ++i) all &= bytes[i];
+    return all != 0;
+}
+
+bool isNumericType(const QVariant& value) {
+    switch (value.type()) {
+    case QVariant::Int:
+    case QVariant::Double:
+    case QVariant::Bool:
+    case QVariant::LongLong:
+    case QVariant::UInt:
+    case QVariant::ULongLong:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// 与 ExpressionParser 中按整数比较的类型一致
+bool isIntegerType(const QVariant& value) {
+    switch (value.type()) {
+    case QVariant::Int:
+    case QVariant::Bool:
+    case QVariant::LongLong:
+    case QVariant::UInt:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // anonymous namespace
+
+// ========== BatchColumns ==========
+
+void BatchColumns::setNumbers(const QString& name, const QVector<double>& values) {
+    Q_ASSERT(values.size() == m_rows);
+    Column column;
+    column.numeric = true;
+    column.numbers = values;
+    column.numbers.resize(m_rows);
+    m_columns.insert(name, column);
+}
+
+void BatchColumns::setIntegers(const QString& name, const QVector<qint64>& values) {
+    Q_ASSERT(values.size() == m_rows);
+    Column column;
+    column.numeric = true;
+    column.integers = values;
+    column.integers.resize(m_rows);
+    column.numbers.resize(m_rows);
+    for (int i = 0; i < m_rows; ++i) {
+        column.numbers[i] = double(column.integers.at(i));
+    }
+    m_columns.insert(name, column);
+}
+
+void BatchColumns::setStrings(const QString& name, const QStringList& values) {
+    Q_ASSERT(values.size() == m_rows);
+    Column column;
+    column.codes.resize(m_rows);
+
+    QHash<QString, int> index;
+    for (int i = 0; i < m_rows && i < values.size(); ++i) {
+        const QString& value = values.at(i);
+        if (value.isNull()) {
+            column.codes[i] = 0;
+            continue;
+        }
+        auto it = index.constFind(value);
+        if (it == index.constEnd()) {
+            column.dictionary.append(value);
+            it = index.insert(value, column.dictionary.size());
+        }
+        column.codes[i] = it.value();
+    }
+    m_columns.insert(name, column);
+}
+
+QVariant BatchColumns::value(const QString& name, int row) const {
+    auto it = m_columns.constFind(name);
+    if (it == m_columns.constEnd() || row < 0 || row >= m_rows) {
+        return QVariant();
+    }
+    if (it->numeric) {
+        double number = it->numbers.at(row);
+        if (number != number) {
+            return QVariant();
+        }
+        return it->integers.isEmpty() ? QVariant(number) : QVariant(it->integers.at(row));
+    }
+    int code = it->codes.at(row);
+    return code > 0 ? QVariant(it->dictionary.at(code - 1)) : QVariant();
+}
+
+BatchColumns BatchColumns::fromRecords(const QList<QVariantMap>& records, const QStringList& names) {
+    BatchColumns columns(records.size());
+    for (const QString& name : names) {
+        bool numeric = true;
+        bool integral = true;
+        for (const QVariantMap& record : records) {
+            QVariant value = record.value(name);
+            if (value.isValid() && !isNumericType(value)) {
+                numeric = false;
+                break;
+            }
+            if (value.isValid() && !isIntegerType(value)) {
+                integral = false;
+            }
+        }
+
+        if (numeric) {
+            QVector<double> numbers(records.size(), Missing);
+            QVector<qint64> integers(integral ? records.size() : 0, 0);
+            for (int i = 0; i < records.size(); ++i) {
+                QVariant value = records.at(i).value(name);
+                if (value.isValid()) {
+                    numbers[i] = value.toDouble();
+                    if (integral) {
+                        integers[i] = value.toLongLong();
+                    }
+                }
+            }
+            columns.setNumbers(name, numbers);
+            columns.m_columns[name].integers = integers;
+        } else {
+            QStringList strings;
+            strings.reserve(records.size());
+            for (const QVariantMap& record : records) {
+                QVariant value = record.value(name);
+                strings.append(value.isValid() ? value.toString() : QString());
+            }
+            columns.setStrings(name, strings);
+        }
+    }
+    return columns;
+}
+
+// ========== BatchMask ==========
+
+BatchMask::BatchMask(int size, bool value)
+    : m_size(size)
+    , m_words((size + 63) / 64, value ? ~quint64(0) : quint64(0))
+{
+    clearTail();
+}
+
+void BatchMask::set(int row, bool value) {
+    quint64 bit = quint64(1) << (row & 63);
+    if (value) {
+        m_words[row >> 6] |= bit;
+    } else {
+        m_words[row >> 6] &= ~bit;
+    }
+}
+
+int BatchMask::count() const {
+    int total = 0;
+    for (quint64 word : m_words) {
+        total += qPopulationCount(word);
+    }
+    return total;
+}
+
+QVector<int> BatchMask::indices() const {
+    QVector<int> rows;
+    rows.reserve(count());
+    for (int w = 0; w < m_words.size(); ++w) {
+        quint64 word = m_words.at(w);
+        while (word) {
+            rows.append(w * 64 + int(qCountTrailingZeroBits(word)));
+            word &= word - 1;
+        }
+    }
+    return rows;
+}
+
+BatchMask& BatchMask::operator&=(const BatchMask& other) {
+    Q_ASSERT(other.m_size == m_size);
+    quint64* words = m_words.data();
+    const quint64* others = other.m_words.constData();
+    for (int i = 0; i < m_words.size(); ++i) words[i] &= others[i];
+    return *this;
+}
+
+BatchMask& BatchMask::operator|=(const BatchMask& other) {
+    Q_ASSERT(other.m_size == m_size);
+    quint64* words = m_words.data();
+    const quint64* others = other.m_words.constData();
+    for (int i = 0; i < m_words.size(); ++i) words[i] |= others[i];
+    return *this;
+}
+
+BatchMask BatchMask::operator~() const {
+    BatchMask result(*this);
+    quint64* words = result.m_words.data();
+    for (int i = 0; i < result.m_words.size(); ++i) words[i] = ~words[i];
+    result.clearTail();
+    return result;
+}
+
+void BatchMask::clearTail() {
+    // 最后一个字中超出 size 的位保持为0，count() 无需特殊处理
+    if (m_size % 64 != 0 && !m_words.isEmpty()) {
+        m_words.last() &= (quint64(1) << (m_size % 64)) - 1;
+    }
+}
+
+// ========== BatchEvaluator ==========
+
+struct BatchEvaluator::Scratch {
+    std::vector<std::vector<quint8>> buffers;           // 每层一个临时字节数组
+    QHash<const Condition*, QVector<quint8>> lookups;   // 字符串列：字典编码 → 比较结果
+
+    quint8* buffer(int depth) {
+        if (int(buffers.size()) <= depth) {
+            buffers.resize(depth + 1, std::vector<quint8>(BlockRows));
+        }
+        return buffers[depth].data();
+    }
+};
+
+BatchMask BatchEvaluator::evaluate(const CompiledExpression& expression, const BatchColumns& columns) {
+    BatchMask mask(columns.rows(), false);
+    if (!expression.isValid()) {
+        return mask;
+    }
+
+    for (const QString& name : expression.variables()) {
+        if (!columns.contains(name)) {
+            qWarning() << "[Quik] Batch column not found, treated as missing:" << name;
+        }
+    }
+
+    Scratch scratch;
+    std::vector<quint8> bytes(BlockRows);
+    for (int begin = 0; begin < columns.rows(); begin += BlockRows) {
+        int count = qMin(BlockRows, columns.rows() - begin);
+        evaluateNode(expression, expression.m_root, columns, begin, count, bytes.data(), scratch, 0);
+        pack(bytes.data(), begin, count, mask);
+    }
+    return mask;
+}
+
+void BatchEvaluator::evaluateNode(const CompiledExpression& expression, int index, const BatchColumns& columns,
+                                  int begin, int count, quint8* out, Scratch& scratch, int depth) {
+    const CompiledExpression::Node& node = expression.m_nodes[index];
+    const int* children = expression.m_children.constData() + node.first;
+
+    switch (node.kind) {
+    case CompiledExpression::NodeKind::Compare:
+        evaluateLeaf(expression.m_leaves[node.leaf], columns, begin, count, out, scratch);
+        return;
+
+    case CompiledExpression::NodeKind::Not:
+        evaluateNode(expression, children[0], columns, begin, count, out, scratch, depth + 1);
+        for (int i = 0; i < count; ++i) out[i] ^= 1;
+        return;
+
+    case CompiledExpression::NodeKind::And:
+    case CompiledExpression::NodeKind::Or: {
+        // 子节点写入本层的临时数组再合并，整块已确定时不再求值其余子节点
+        const bool isAnd = node.kind == CompiledExpression::NodeKind::And;
+        evaluateNode(expression, children[0], columns, begin, count, out, scratch, depth + 1);
+        quint8* temp = scratch.buffer(depth);
+        for (int c = 1; c < node.count; ++c) {
+            if (isAnd ? !anySet(out, count) : allSet(out, count)) {
+                return;
+            }
+            evaluateNode(expression, children[c], columns, begin, count, temp, scratch, depth + 1);
+            if (isAnd) {
+                for (int i = 0; i < count; ++i) out[i] &= temp[i];
+            } else {
+                for (int i = 0; i < count; ++i) out[i] |= temp[i];
+            }
+        }
+        return;
+    }
+    }
+}
+
+void BatchEvaluator::evaluateLeaf(const Condition& condition, const BatchColumns& columns,
+                                  int begin, int count, quint8* out, Scratch& scratch) {
+    auto left = columns.m_columns.constFind(condition.variable);
+    if (left == columns.m_columns.constEnd()) {
+        std::fill(out, out + count, quint8(0));
+        return;
+    }
+
+    // 右侧是变量：两列都是数值时逐元素比较，否则逐行求值
+    if (condition.isRightVariable) {
+        auto right = columns.m_columns.constFind(condition.compareVariable);
+        if (right == columns.m_columns.constEnd()) {
+            std::fill(out, out + count, quint8(0));
+        } else if (left->numeric && right->numeric) {
+            const double* rightNumbers = right->numbers.constData() + begin;
+            compareNumbers(condition.compareOp, left->numbers.constData() + begin,
+                           [rightNumbers](int i) { return rightNumbers[i]; }, count, out);
+        } else {
+            evaluateRows(condition, columns, begin, count, out);
+        }
+        return;
+    }
+
+    // 字符串列：字典中每个值求值一次，之后按编码查表
+    if (!left->numeric) {
+        auto lookup = scratch.lookups.find(&condition);
+        if (lookup == scratch.lookups.end()) {
+            QVector<quint8> table(left->dictionary.size() + 1, quint8(0));
+            QVariantMap context;
+            for (int k = 0; k < left->dictionary.size(); ++k) {
+                context.insert(condition.variable, left->dictionary.at(k));
+                table[k + 1] = ExpressionParser::evaluate(condition, context) ? 1 : 0;
+            }
+            lookup = scratch.lookups.insert(&condition, table);
+        }
+        const quint8* table = lookup->constData();
+        const int* codes = left->codes.constData() + begin;
+        for (int i = 0; i < count; ++i) out[i] = table[codes[i]];
+        return;
+    }
+
+    // 数值列与常量
+    const double* numbers = left->numbers.constData() + begin;
+    switch (condition.literalType) {
+    case LiteralType::Integer:
+        if (!left->integers.isEmpty()) {
+            compareIntegers(condition.compareOp, left->integers.constData() + begin, numbers,
+                            condition.literalInt, count, out);
+            return;
+        }
+        // fall through
+    case LiteralType::Double: {
+        const double literal = condition.literalDouble;
+        compareNumbers(condition.compareOp, numbers, [literal](int) { return literal; }, count, out);
+        return;
+    }
+    case LiteralType::String:
+        // 数值的字符串形式不会等于非数值常量
+        if (condition.compareOp == CompareOp::Equal) {
+            std::fill(out, out + count, quint8(0));
+            return;
+        }
+        if (condition.compareOp == CompareOp::NotEqual) {
+            for (int i = 0; i < count; ++i) out[i] = present(numbers[i]);
+            return;
+        }
+        break;
+    case LiteralType::Set:
+        if (condition.stringSet.isEmpty()) {
+            // 与逐行求值相同的二分查找，缺失的行（NaN）不匹配
+            for (int i = 0; i < count; ++i) {
+                out[i] = quint8(ExpressionParser::containsNumber(condition, numbers[i]));
+            }
+            if (condition.compareOp == CompareOp::NotIn) {
+                for (int i = 0; i < count; ++i) out[i] = (out[i] ^ 1) & present(numbers[i]);
+            }
+            return;
+        }
+        break;
+    case LiteralType::None:
+        break;
+    }
+
+    evaluateRows(condition, columns, begin, count, out);
+}
+
+void BatchEvaluator::evaluateRows(const Condition& condition, const BatchColumns& columns,
+                                  int begin, int count, quint8* out) {
+    QVariantMap context;
+    for (int i = 0; i < count; ++i) {
+        QVariant left = columns.value(condition.variable, begin + i);
+        QVariant right = condition.isRightVariable ? columns.value(condition.compareVariable, begin + i) : QVariant();
+        if (!left.isValid() || (condition.isRightVariable && !right.isValid())) {
+            out[i] = 0;
+            continue;
+        }
+        context.insert(condition.variable, left);
+        if (condition.isRightVariable) {
+            context.insert(condition.compareVariable, right);
+        }
+        out[i] = ExpressionParser::evaluate(condition, context) ? 1 : 0;
+    }
+}
+
+void BatchEvaluator::pack(const quint8* bytes, int begin, int count, BatchMask& mask) {
+    // begin 是 64 的倍数，每 64 个字节合成一个字
+    quint64* words = mask.m_words.data() + (begin >> 6);
+    for (int w = 0; w * 64 < count; ++w) {
+        const quint8* chunk = bytes + w * 64;
+        const int n = qMin(64, count - w * 64);
+        quint64 bits = 0;
+        for (int j = 0; j < n; ++j) bits |= quint64(chunk[j] & 1) << j;
+        words[w] = bits;
+    }
+}
+
+BatchMask BatchEvaluator::validate(const ValidationRule& rule, const QString& name, const BatchColumns& columns) {
+    const int rows = columns.rows();
+    if (rule.isEmpty()) {
+        return BatchMask(rows, true);
+    }
+
+    // 缺失的值按空文本校验（与界面中未填写一致）
+    const quint8 missingPasses = rule.check(QString()).isEmpty() ? 1 : 0;
+    auto column = columns.m_columns.constFind(name);
+    if (column == columns.m_columns.constEnd()) {
+        return BatchMask(rows, missingPasses != 0);
+    }
+
+    BatchMask mask(rows, false);
+    std::vector<quint8> bytes(BlockRows);
+    const bool numericRule = rule.valid == "int" || rule.valid == "double";
+
+    // 字符串列：字典中每个值校验一次
+    QVector<quint8> table;
+    if (!column->numeric) {
+        table.resize(column->dictionary.size() + 1);
+        table[0] = missingPasses;
+        for (int k = 0; k < column->dictionary.size(); ++k) {
+            table[k + 1] = rule.check(column->dictionary.at(k)).isEmpty() ? 1 : 0;
+        }
+    }
+
+    for (int begin = 0; begin < rows; begin += BlockRows) {
+        const int count = qMin(BlockRows, rows - begin);
+        quint8* out = bytes.data();
+
+        if (!column->numeric) {
+            const quint8* lookup = table.constData();
+            const int* codes = column->codes.constData() + begin;
+            for (int i = 0; i < count; ++i) out[i] = lookup[codes[i]];
+        } else if (numericRule) {
+            // 有值时只检查范围（数值总能转换），缺失时按空文本的结果
+            const double* numbers = column->numbers.constData() + begin;
+            const double min = rule.min;
+            const double max = rule.max;
+            for (int i = 0; i < count; ++i) {
+                quint8 has = present(numbers[i]);
+                quint8 inRange = quint8(numbers[i] >= min) & quint8(numbers[i] <= max);
+                out[i] = (has & inRange) | ((has ^ 1) & missingPasses);
+            }
+        } else {
+            for (int i = 0; i < count; ++i) {
+                QVariant value = columns.value(name, begin + i);
+                out[i] = rule.check(value.isValid() ? value.toString() : QString()).isEmpty() ? 1 : 0;
+            }
+        }
+
+        pack(out, begin, count, mask);
+    }
+    return mask;
+}
+
+} // namespace Quik
@@ -0,0 +1,189 @@
+#ifndef BATCHEVALUATOR_H
+#define BATCHEVALUATOR_H
+
+#include "Quik/QuikAPI.h"
+#include "parser/ExpressionParser.h"
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QVariantMap>
+
+namespace Quik {
+
+struct ValidationRule;
+
+/**
+ * @brief 按列存储的批量输入
+ *
+ * 每个变量一列，所有列的行数相同。数值列为 double 数组（NaN 表示缺失），
+ * 整数列另存一份 qint64，与整数常量按整数精确比较（与逐行求值一致）；
+ * 字符串列做字典编码：每行只存一个整数编码，比较只对字典中的每个不同值做一次。
+ *
+ * 使用示例：
+ * @code
+ * BatchColumns columns(records.size());
+ * columns.setNumbers("level", levels);            // QVector<double>
+ * columns.setIntegers("id", ids);                 // QVector<qint64>
+ * columns.setStrings("mode", modes);              // QStringList
+ * @endcode
+ */
+class QUIK_API BatchColumns {
+public:
+    explicit BatchColumns(int rows = 0) : m_rows(rows) {}
+
+    /**
+     * @brief 行数
+     */
+    int rows() const { return m_rows; }
+
+    /**
+     * @brief 设置数值列
+     * @param name 变量名（不含$）
+     * @param values 每行的值，NaN 表示缺失，长度须等于行数
+     */
+    void setNumbers(const QString& name, const QVector<double>& values);
+
+    /**
+     * @brief 设置整数列
+     * @param name 变量名（不含$）
+     * @param values 每行的值，长度须等于行数（整数列没有缺失值，有缺失时使用 fromRecords）
+     */
+    void setIntegers(const QString& name, const QVector<qint64>& values);
+
+    /**
+     * @brief 设置字符串列
+     * @param name 变量名（不含$）
+     * @param values 每行的值，空（isNull）表示缺失，长度须等于行数
+     */
+    void setStrings(const QString& name, const QStringList& values);
+
+    /**
+     * @brief 是否有该变量的列
+     */
+    bool contains(const QString& name) const { return m_columns.contains(name); }
+
+    /**
+     * @brief 取单个值（用于无法向量化的比较，缺失时返回无效QVariant）
+     */
+    QVariant value(const QString& name, int row) const;
+
+    /**
+     * @brief 从按行存储的记录转换
+     * @param records 记录列表，如多个参数文件的 getAllValues()
+     * @param names 需要的变量
+     *
+     * 某列所有值都是数值类型（int、double、bool 等）时存为数值列，其中都是整数类型（int、qint64、uint、bool）
+     * 时同时存为整数列，否则存为字符串列。
+     */
+    static BatchColumns fromRecords(const QList<QVariantMap>& records, const QStringList& names);
+
+private:
+    friend class BatchEvaluator;
+
+    struct Column {
+        bool numeric = false;
+        QVector<double> numbers;        // 数值列
+        QVector<qint64> integers;       // 整数列（为空表示不是整数列），缺失的行由 numbers 中的 NaN 标记
+        QVector<int> codes;             // 字符串列：0 表示缺失，k 表示 dictionary[k - 1]
+        QStringList dictionary;
+    };
+
+    int m_rows = 0;
+    QHash<QString, Column> m_columns;
+};
+
+/**
+ * @brief 批量求值结果（每行一位）
+ */
+class QUIK_API BatchMask {
+public:
+    explicit BatchMask(int size = 0, bool value = false);
+
+    int size() const { return m_size; }
+
+    bool test(int row) const { return (m_words[row >> 6] >> (row & 63)) & 1; }
+
+    void set(int row, bool value);
+
+    /**
+     * @brief 为1的行数
+     */
+    int count() const;
+
+    /**
+     * @brief 为1的行号（升序）
+     */
+    QVector<int> indices() const;
+
+    BatchMask& operator&=(const BatchMask& other);
+    BatchMask& operator|=(const BatchMask& other);
+    BatchMask operator~() const;
+
+    /**
+     * @brief 底层的64位字（第 i 行在 words[i / 64] 的第 i % 64 位）
+     */
+    const QVector<quint64>& words() const { return m_words; }
+
+private:
+    friend class BatchEvaluator;
+
+    void clearTail();
+
+    int m_size = 0;
+    QVector<quint64> m_words;
+};
+
+/**
+ * @brief 对大量记录批量求值已编译的表达式
+ *
+ * 按块（4096 行）遍历表达式树：每个比较是一个对连续数组的无分支循环，
+ * and/or/not 是对字节数组的按位运算，编译器可以自动向量化（建议 -O3 或开启 -ftree-vectorize）；
+ * and 的某个子节点在整块上都为假时跳过其余子节点（or 全为真时同理）。
+ *
+ * 结果与逐行调用 CompiledExpression::evaluate 一致：缺失的变量使比较为假；
+ * 数值按 double 比较（== 和 in 同样使用模糊比较），整数列与整数常量按 qint64 精确比较；
+ * 字符串列在字典上逐值求值后按编码查表。
+ * 少数组合（数值列与字符串常量的大小比较、两个字符串列的比较等）逐行求值，结果同样正确。
+ * 计算变量不会被求值，需要时作为普通列提供。
+ *
+ * 使用示例：
+ * @code
+ * CompiledExpression expr = ExpressionParser::compile("$mode in [1, 3] and $level>=2");
+ * BatchMask visible = BatchEvaluator::evaluate(expr, columns);
+ * qDebug() << visible.count() << "of" << columns.rows() << "records show the field";
+ * @endcode
+ */
+class QUIK_API BatchEvaluator {
+public:
+    /**
+     * @brief 批量求值
+     * @param expression 已编译的表达式，未编译成功时结果全为0
+     * @param columns 输入列，缺少的变量视为每行缺失
+     */
+    static BatchMask evaluate(const CompiledExpression& expression, const BatchColumns& columns);
+
+    /**
+     * @brief 批量校验
+     * @param rule 校验规则
+     * @param name 被校验的变量
+     * @param columns 输入列
+     * @return 通过校验的行（与 ValidationRule::check 返回空一致）
+     */
+    static BatchMask validate(const ValidationRule& rule, const QString& name, const BatchColumns& columns);
+
+private:
+    struct Scratch;
+
+    static void evaluateNode(const CompiledExpression& expression, int index, const BatchColumns& columns,
+                             int begin, int count, quint8* out, Scratch& scratch, int depth);
+    static void evaluateLeaf(const Condition& condition, const BatchColumns& columns,
+                             int begin, int count, quint8* out, Scratch& scratch);
+    static void evaluateRows(const Condition& condition, const BatchColumns& columns,
+                             int begin, int count, quint8* out);
+    static void pack(const quint8* bytes, int begin, int count, BatchMask& mask);
+};
+
+} // namespace Quik
+
+#endif // BATCHEVALUATOR_H
@@ -0,0 +1,46 @@
+#include "LatencyHistogram.h"
+#include <cmath>
+
+namespace Quik {
+
+int LatencyHistogram::bucketFor(qint64 us) {
+    if (us <= 1) return 0;
+    int bucket = int(std::ceil(2.0 * std::log2(double(us))));
+    return qBound(0, bucket, BucketCount - 1);
+}
+
+qint64 LatencyHistogram::upperBound(int bucket) {
+    return qint64(std::ceil(std::pow(2.0, bucket / 2.0)));
+}
+
+void LatencyHistogram::add(qint64 us) {
+    ++m_buckets[bucketFor(us)];
+    ++m_count;
+    m_max = qMax(m_max, us);
+}
+
+qint64 LatencyHistogram::percentile(double p) const {
+    if (m_count == 0) return 0;
+
+    // 第 rank 个样本所在的桶
+    quint64 rank = quint64(std::ceil(qBound(0.0, p, 1.0) * m_count));
+    if (rank == 0) rank = 1;
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            return qMin(upperBound(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+void LatencyHistogram::clear() {
+    for (int i = 0; i < BucketCount; ++i) {
+        m_buckets[i] = 0;
+    }
+    m_count = 0;
+    m_max = 0;
+}
+
+} // namespace Quik
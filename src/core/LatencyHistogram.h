@@ -0,0 +1,59 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include "Quik/QuikAPI.h"
+#include <QtGlobal>
+
+namespace Quik {
+
+/**
+ * @brief 对数分桶的延迟直方图
+ *
+ * 每个桶覆盖半个倍频程（上界依次为 1、1.4、2、2.8、4 ... 微秒），最大约 12 秒，
+ * 固定大小、无分配，add 为 O(1)。百分位返回所在桶的上界，相对误差不超过 41%，
+ * 足以区分 "1 帧内" 和 "卡顿"。
+ */
+class QUIK_API LatencyHistogram {
+public:
+    static const int BucketCount = 48;
+
+    /**
+     * @brief 记录一个样本
+     * @param us 延迟（微秒）
+     */
+    void add(qint64 us);
+
+    /**
+     * @brief 样本数
+     */
+    quint64 count() const { return m_count; }
+
+    /**
+     * @brief 百分位延迟（微秒）
+     * @param p 百分位，0~1，如 0.5、0.99
+     * @return 所在桶的上界，无样本时返回0
+     */
+    qint64 percentile(double p) const;
+
+    /**
+     * @brief 最大延迟（微秒，精确值）
+     */
+    qint64 max() const { return m_max; }
+
+    /**
+     * @brief 清空
+     */
+    void clear();
+
+private:
+    static int bucketFor(qint64 us);
+    static qint64 upperBound(int bucket);
+
+    quint64 m_buckets[BucketCount] = {};
+    quint64 m_count = 0;
+    qint64 m_max = 0;
+};
+
+} // namespace Quik
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,102 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+namespace Quik {
+
+/**
+ * @brief 无锁多生产者单消费者队列
+ *
+ * 基于 Vyukov 的侵入式 MPSC 队列：push 只有一次原子交换，可在任意线程调用；
+ * tryPop 只能由单一消费者线程（GUI线程）调用。
+ *
+ * 当生产者正处于 push 中途时 tryPop 可能暂时返回 false，
+ * 调用方需要在生产者完成后再次消费（QuikContext 通过调度标志保证这一点）。
+ */
+template<typename T>
+class MpscQueue {
+public:
+    MpscQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+    ~MpscQueue() {
+        T value;
+        while (tryPop(value)) {}
+    }
+
+    /**
+     * @brief 入队（线程安全，可由任意线程调用）
+     */
+    void push(T value) {
+        pushNode(new Node(std::move(value)));
+    }
+
+    /**
+     * @brief 出队（仅限消费者线程）
+     * @param out 出队的值
+     * @return 是否取到值
+     */
+    bool tryPop(T& out) {
+        Node* tail = m_tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+
+        // 跳过占位节点
+        if (tail == &m_stub) {
+            if (!next) return false;
+            m_tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next) {
+            m_tail = next;
+            out = std::move(tail->value);
+            delete tail;
+            return true;
+        }
+
+        // tail 是最后一个节点：若 head 不同说明有生产者正在链接，稍后再取
+        if (tail != m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        // 重新放入占位节点，使 tail 可以被安全取出
+        pushNode(&m_stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            m_tail = next;
+            out = std::move(tail->value);
+            delete tail;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    struct Node {
+        Node() : next(nullptr) {}
+        explicit Node(T&& v) : next(nullptr), value(std::move(v)) {}
+
+        std::atomic<Node*> next;
+        T value;
+    };
+
+    void pushNode(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // 禁止拷贝
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    std::atomic<Node*> m_head;  // 生产者端（最新节点）
+    Node* m_tail;               // 消费者端
+    Node m_stub;                // 占位节点
+};
+
+} // namespace Quik
+
+#endif // MPSCQUEUE_H
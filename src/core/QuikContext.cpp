@@ -1,23 +1,34 @@
 #include "QuikContext.h"
-#include <QCheckBox>
+#include "widget/WidgetAdapter.h"
+#include "core/QuikTrace.h"
+#include "core/QuikReplay.h"
+#include "core/BatchEvaluator.h"
 #include <QComboBox>
-#include <QLineEdit>
-#include <QSpinBox>
-#include <QDoubleSpinBox>
-#include <QRadioButton>
-#include <QLabel>
-#include <QSlider>
-#include <QProgressBar>
 #include <QLayout>
+#include <QBoxLayout>
+#include <QDataStream>
+#include <QTimer>
+#include <QEvent>
 #include <QDebug>
+#include <memory>
+#include <algorithm>
 
 namespace Quik {
 
+namespace {
+
+// 一次传播允许的最大轮数，超过视为监听回调之间的循环写入
+const int MaxPropagationWaves = 100;
+
+} // anonymous namespace
+
 QuikContext::QuikContext(QObject* parent)
     : QObject(parent)
+    , m_postTimer(new QTimer(this))
 {
-    connect(this, &QuikContext::variableChanged,
-            this, &QuikContext::onVariableChanged);
+    // 绑定在传播过程中按轮统一更新，不再通过 variableChanged 逐个触发
+    m_postTimer->setSingleShot(true);
+    connect(m_postTimer, &QTimer::timeout, this, &QuikContext::flushPostedValues);
 }
 
 QuikContext::~QuikContext() = default;
@@ -25,32 +36,217 @@ QuikContext::~QuikContext() = default;
 // ========== 变量管理 ==========
 
 void QuikContext::registerVariable(const QString& name, QWidget* widget) {
+    // 按组件类型解析一次适配器，之后的同步直接使用
+    BoundWidget bound;
+    bound.widget = widget;
+    bound.adapter = widget ? WidgetAdapterRegistry::instance().resolve(widget->metaObject()) : nullptr;
+    
     // 添加到组件列表（支持多个组件绑定同一变量）
-    m_widgets[name].append(widget);
+    m_widgets[name].append(bound);
     
     // 如果变量已有值，先同步到新组件
     if (m_values.contains(name)) {
-        syncSingleWidget(widget, m_values[name]);
+        syncSingleWidget(bound, m_values[name]);
     }
     
     // 自动连接组件的值变化信号
-    autoConnectWidget(name, widget);
+    autoConnectWidget(name, bound);
     
     qDebug() << "[Quik] Registered variable:" << name << "(total widgets:" << m_widgets[name].size() << ")";
 }
 
 void QuikContext::setValue(const QString& name, const QVariant& value) {
-    if (m_values.value(name) != value) {
-        m_values[name] = value;
+    QUIK_TRACE_SCOPE_DETAIL("setValue", name);
+    
+    if (assignValue(name, value)) {
+        propagate();
+    } else if (!m_pendingInputs.isEmpty()) {
+        // 值没有变化，不会有传播和绘制，放弃这次输入的计时
+        m_pendingInputs.remove(name);
+    }
+}
+
+bool QuikContext::assignValue(const QString& name, const QVariant& value) {
+    // 计算变量由表达式决定，忽略外部写入（如加载JSON、热更新恢复状态）
+    if (m_computed.contains(name)) {
+        qDebug() << "[Quik] Ignored write to computed variable:" << name;
+        return false;
+    }
+    
+    if (m_values.value(name) == value) {
+        return false;
+    }
+    
+    // 值立即生效，通知延后到传播的下一轮
+    m_values[name] = value;
+    markDirty(name);
+    
+    if (m_recorder) {
+        m_recorder->recordValue(name, value);
+    }
+    return true;
+}
+
+void QuikContext::markDirty(const QString& name) {
+    if (!m_dirtySet.contains(name)) {
+        m_dirtySet.insert(name);
+        m_dirty.append(name);
+    }
+    
+    // 记录写入来源（正在执行哪个变量的监听），用于循环诊断
+    if (m_propagating) {
+        m_writers[name] = m_activeSource;
+    }
+}
+
+void QuikContext::propagate() {
+    // 监听回调中的写入只标记为脏，由最外层的传播在下一轮处理，不会递归
+    if (m_propagating) {
+        return;
+    }
+    QUIK_TRACE_SCOPE("propagate");
+    m_propagating = true;
+    m_writers.clear();
+    beginLayoutBatch();
+    QStringList completedInputs;
+    
+    int wave = 0;
+    while (!m_dirty.isEmpty()) {
+        if (++wave > MaxPropagationWaves) {
+            reportPropagationCycle();
+            m_dirty.clear();
+            m_dirtySet.clear();
+            break;
+        }
+        
+        QStringList changed = m_dirty;
+        m_dirty.clear();
+        m_dirtySet.clear();
+        QUIK_TRACE_SCOPE_DETAIL("wave", changed.join(", "));
         
-        // 同步更新UI组件
-        syncWidgetFromValue(name, value);
-        emit variableChanged(name, value);
+        if (!m_pendingInputs.isEmpty()) {
+            for (const QString& name : changed) {
+                // 写回自身的 watcher（如限幅）会让同一输入在多轮中变化，只记录一次
+                if (m_pendingInputs.contains(name) && !completedInputs.contains(name)) {
+                    completedInputs.append(name);
+                }
+            }
+        }
+        
+        // 1. 按拓扑顺序更新计算值，之后所有值都处于一致状态
+        changed += recomputeComputed(changed);
         
-        // 触发单变量监听回调
-        if (m_watchers.contains(name)) {
-            m_watchers[name](value);
+        // 2. 同步组件
+        for (const QString& name : changed) {
+            syncWidgetFromValue(name, m_values.value(name));
         }
+        
+        // 3. 受影响的表达式每个只求值一次
+        updateDependentBindings(changed);
+        
+        // q-filter 引用的变量变化时增量更新对应的 q-for
+        updateGeneralQForViews(changed);
+        
+        // 4. 通知外部，回调中的写入进入下一轮
+        for (const QString& name : changed) {
+            QVariant value = m_values.value(name);
+            m_activeSource = name;
+            emit variableChanged(name, value);
+            
+            auto watcher = m_watchers.constFind(name);
+            if (watcher != m_watchers.constEnd()) {
+                std::function<void(const QVariant&)> callback = watcher.value();
+                invokeWatcher(name, callback, value);
+            }
+        }
+        m_activeSource.clear();
+    }
+    
+    endLayoutBatch();
+    m_propagating = false;
+    
+    if (!completedInputs.isEmpty()) {
+        finishInputPropagation(completedInputs);
+    }
+}
+
+void QuikContext::reportPropagationCycle() {
+    // 从最后写入的变量沿写入来源回溯，直到出现重复
+    QStringList chain;
+    QString current = m_dirty.isEmpty() ? QString() : m_dirty.first();
+    while (!current.isEmpty() && !chain.contains(current)) {
+        chain.prepend(current);
+        current = m_writers.value(current);
+    }
+    if (!current.isEmpty()) {
+        chain.prepend(current);
+    }
+    
+    qWarning() << "[Quik] Propagation did not settle after" << MaxPropagationWaves
+               << "waves - watchers keep writing to each other:" << chain.join(" -> ");
+    qWarning() << "[Quik] Pending variables dropped:" << m_dirty;
+}
+
+// ========== 跨线程投递 ==========
+
+void QuikContext::postValue(const QString& name, const QVariant& value) {
+    PostedValue posted;
+    posted.name = name;
+    posted.value = value;
+    m_postQueue.push(std::move(posted));
+    
+    // 只有第一个投递者负责调度，其余投递只入队
+    if (!m_postScheduled.exchange(true)) {
+        QMetaObject::invokeMethod(this, "schedulePostedValues", Qt::QueuedConnection);
+    }
+}
+
+void QuikContext::setPostInterval(int msec) {
+    m_postInterval = qMax(0, msec);
+}
+
+void QuikContext::schedulePostedValues() {
+    if (m_postTimer->isActive()) {
+        return;
+    }
+    
+    // 距上次应用不足一个间隔时，延迟到间隔结束
+    qint64 elapsed = m_lastPostFlush.isValid() ? m_lastPostFlush.elapsed() : m_postInterval;
+    if (elapsed >= m_postInterval) {
+        flushPostedValues();
+    } else {
+        m_postTimer->start(int(m_postInterval - elapsed));
+    }
+}
+
+void QuikContext::flushPostedValues() {
+    QUIK_TRACE_SCOPE("flushPostedValues");
+    
+    // 先清除调度标志再取队列：之后的投递会重新调度，不会丢失
+    m_postScheduled.store(false);
+    m_lastPostFlush.start();
+    
+    // 合并：每个变量只保留最后一次写入，按首次出现的顺序应用
+    QStringList order;
+    QHash<QString, QVariant> latest;
+    PostedValue posted;
+    while (m_postQueue.tryPop(posted)) {
+        auto it = latest.find(posted.name);
+        if (it == latest.end()) {
+            order.append(posted.name);
+            latest.insert(posted.name, posted.value);
+        } else {
+            it.value() = posted.value;
+        }
+    }
+    
+    // 整批写入后只传播一次
+    bool changed = false;
+    for (const QString& name : order) {
+        changed |= assignValue(name, latest.value(name));
+    }
+    if (changed) {
+        propagate();
     }
 }
 
@@ -59,8 +255,11 @@ QVariant QuikContext::getValue(const QString& name) const {
 }
 
 QWidget* QuikContext::getWidget(const QString& name) const {
-    const QList<QWidget*>& widgets = m_widgets.value(name);
-    return widgets.isEmpty() ? nullptr : widgets.first();
+    auto it = m_widgets.constFind(name);
+    if (it == m_widgets.constEnd() || it.value().isEmpty()) {
+        return nullptr;
+    }
+    return it.value().first().widget;
 }
 
 // ========== 属性绑定 ==========
@@ -78,193 +277,1182 @@ void QuikContext::bindProperty(QWidget* widget, const QString& property, const Q
         return;
     }
     
-    PropertyBinding binding;
-    binding.widget = widget;
-    binding.property = property;
-    binding.expression = expression;
-    
-    // 检查是否是复合表达式（包含 and/or）
-    QString cleanExpr = expression.trimmed();
-    bool isCompound = cleanExpr.contains(" and ", Qt::CaseInsensitive) || 
-                      cleanExpr.contains(" or ", Qt::CaseInsensitive);
+    PropertyBinding binding;
+    binding.widget = widget;
+    binding.property = property;
+    binding.expression = expression;
+    addBinding(binding);
+}
+
+void QuikContext::addBinding(PropertyBinding binding) {
+    CompiledExpression compiled = ExpressionParser::compile(binding.expression);
+    if (!compiled.isValid()) {
+        qWarning() << "[Quik] Failed to parse expression:" << binding.expression;
+        return;
+    }
+    
+    if (compiled.isSingleCondition()) {
+        binding.condition = compiled.leaves().first();
+    } else {
+        binding.condition.isValid = true;  // 复合表达式，使用表达式树求值
+    }
+    
+    // 相同表达式共用一个节点，依赖只在节点首次被绑定时登记
+    binding.expressionId = internExpression(compiled);
+    SharedExpression& node = m_expressions[binding.expressionId];
+    if (node.bindings.isEmpty()) {
+        for (const QString& var : node.variables) {
+            m_dependencies[var].append(binding.expressionId);
+            qDebug() << "[Quik] Tracking variable:" << var << "for expression:" << node.expression;
+        }
+    }
+    
+    int bindingId = m_nextBindingId++;
+    node.bindings.append(bindingId);
+    m_allBindings.insert(bindingId, binding);
+    
+    qDebug() << "[Quik] Bound" << binding.property << "of" << (binding.widget ? QStringLiteral("widget") : binding.field)
+             << "to expression:" << binding.expression << "(shared by" << node.bindings.size() << "bindings)";
+}
+
+int QuikContext::internExpression(const CompiledExpression& compiled) {
+    if (compiled.isSingleCondition()) {
+        return internCondition(compiled.leaves().first());
+    }
+    
+    QString key = compiled.toString();
+    auto found = m_expressionIndex.constFind(key);
+    if (found != m_expressionIndex.constEnd()) {
+        return found.value();
+    }
+    
+    // 复合表达式：每个比较也是共享节点，不同表达式中相同的子条件只求值一次
+    SharedExpression node;
+    node.expression = key;
+    node.compiled = compiled;
+    node.variables = compiled.variables();
+    for (const Condition& cond : compiled.leaves()) {
+        node.leafIds.append(internCondition(cond));
+    }
+    
+    int id = m_expressions.size();
+    m_expressions.append(node);
+    m_expressionIndex.insert(key, id);
+    return id;
+}
+
+int QuikContext::internCondition(const Condition& condition) {
+    QString key = ExpressionParser::toString(condition);
+    auto found = m_expressionIndex.constFind(key);
+    if (found != m_expressionIndex.constEnd()) {
+        return found.value();
+    }
+    
+    SharedExpression node;
+    node.expression = key;
+    node.condition = condition;
+    node.variables.append(condition.variable);
+    if (condition.isRightVariable && condition.compareVariable != condition.variable) {
+        node.variables.append(condition.compareVariable);
+    }
+    
+    int id = m_expressions.size();
+    m_expressions.append(node);
+    m_expressionIndex.insert(key, id);
+    return id;
+}
+
+bool QuikContext::evaluateExpression(int id) {
+    if (m_expressions[id].epoch == m_evalEpoch) {
+        return m_expressions[id].result;
+    }
+    
+    bool result = false;
+    int examined = 0;
+    if (m_expressions[id].condition.isValid) {
+        result = ExpressionParser::evaluate(m_expressions[id].condition, m_values);
+        examined = 1;
+        ++m_evaluations;
+    } else {
+        // 短路遍历表达式树，子条件复用本轮已有的结果
+        const CompiledExpression compiled = m_expressions[id].compiled;
+        const QVector<int> leafIds = m_expressions[id].leafIds;
+        result = compiled.evaluate([this, &leafIds, &examined](int leaf, const Condition&) {
+            ++examined;
+            return evaluateExpression(leafIds[leaf]);
+        });
+    }
+    
+    SharedExpression& node = m_expressions[id];
+    node.epoch = m_evalEpoch;
+    node.result = result;
+    node.examined = examined;
+    return result;
+}
+
+BindingStats QuikContext::bindingStats() const {
+    BindingStats stats;
+    stats.bindings = m_allBindings.size();
+    stats.sharedExpressions = m_expressions.size();
+    stats.evaluations = m_evaluations;
+    stats.evaluationsSaved = m_unsharedEvaluations - m_evaluations;
+    stats.deferred = m_deferredCount;
+    return stats;
+}
+
+void QuikContext::resetBindingStats() {
+    m_evaluations = 0;
+    m_unsharedEvaluations = 0;
+    m_deferredCount = 0;
+}
+
+// ========== 内存统计 ==========
+
+namespace {
+
+// QMap/QHash 节点的额外开销（指针 + 颜色/哈希）
+const qint64 MapNodeOverhead = 3 * sizeof(void*) + sizeof(int);
+const qint64 HashNodeOverhead = 2 * sizeof(void*) + sizeof(uint);
+
+qint64 stringListBytes(const QStringList& list) {
+    qint64 bytes = sizeof(QStringList) + list.size() * sizeof(void*);
+    for (const QString& str : list) {
+        bytes += MemoryStats::sizeOf(str);
+    }
+    return bytes;
+}
+
+// 结构体内联的 QString 已计入 sizeof，这里只加堆上数据
+qint64 stringPayload(const QString& str) {
+    return MemoryStats::sizeOf(str) - qint64(sizeof(QString));
+}
+
+// 解析后的条件：常量的各种形式和集合内容（结构体本身已计入 sizeof）
+qint64 conditionPayload(const Condition& condition) {
+    qint64 bytes = stringPayload(condition.variable) + stringPayload(condition.op) +
+                   MemoryStats::sizeOf(condition.compareValue) - qint64(sizeof(QVariant)) +
+                   stringPayload(condition.literalText) + stringPayload(condition.compareVariable);
+    bytes += condition.numberSet.capacity() * sizeof(double);
+    for (const QString& str : condition.stringSet) {
+        bytes += HashNodeOverhead + MemoryStats::sizeOf(str);
+    }
+    return bytes;
+}
+
+} // anonymous namespace
+
+qint64 MemoryStats::sizeOf(const QString& str) {
+    qint64 bytes = sizeof(QString);
+    if (!str.isNull()) {
+        bytes += sizeof(QArrayData) + (str.capacity() + 1) * sizeof(QChar);
+    }
+    return bytes;
+}
+
+qint64 MemoryStats::sizeOf(const QVariant& value) {
+    qint64 bytes = sizeof(QVariant);
+    switch (value.type()) {
+    case QVariant::String:
+        bytes += stringPayload(value.toString());
+        break;
+    case QVariant::ByteArray:
+        bytes += sizeof(QArrayData) + value.toByteArray().capacity() + 1;
+        break;
+    case QVariant::StringList:
+        bytes += stringListBytes(value.toStringList());
+        break;
+    case QVariant::List: {
+        const QVariantList list = value.toList();
+        bytes += sizeof(QVariantList) + list.size() * sizeof(void*);
+        for (const QVariant& item : list) {
+            bytes += sizeOf(item);
+        }
+        break;
+    }
+    case QVariant::Map: {
+        const QVariantMap map = value.toMap();
+        bytes += sizeof(QVariantMap);
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            bytes += MapNodeOverhead + sizeOf(it.key()) + sizeOf(it.value());
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return bytes;
+}
+
+QString MemoryStats::toString() const {
+    auto line = [](const char* name, int count, qint64 bytes) {
+        return QString("%1 %2 %3 KB\n").arg(name, -12).arg(count, 8).arg(bytes / 1024.0, 10, 'f', 1);
+    };
+    return line("variables", variables, variableBytes) +
+           line("bindings", bindings, bindingBytes) +
+           line("dependencies", dependencies, dependencyBytes) +
+           line("expressions", expressions, expressionBytes) +
+           line("templates", templates, templateBytes) +
+           line("listData", listItems, listDataBytes) +
+           line("widgets", widgets, widgetBytes) +
+           QString("%1 %2 KB\n").arg("total", -21).arg(totalBytes() / 1024.0, 10, 'f', 1);
+}
+
+MemoryStats QuikContext::memoryStats() const {
+    MemoryStats stats;
+    
+    // 变量值
+    stats.variables = m_values.size();
+    for (auto it = m_values.constBegin(); it != m_values.constEnd(); ++it) {
+        stats.variableBytes += MapNodeOverhead + MemoryStats::sizeOf(it.key()) + MemoryStats::sizeOf(it.value());
+    }
+    for (auto it = m_widgets.constBegin(); it != m_widgets.constEnd(); ++it) {
+        stats.variableBytes += MapNodeOverhead + MemoryStats::sizeOf(it.key()) +
+                               sizeof(QList<BoundWidget>) + it.value().size() * (sizeof(void*) + sizeof(BoundWidget));
+    }
+    
+    // 属性绑定（每个绑定保存一份原始表达式和解析后的条件）
+    stats.bindings = m_allBindings.size();
+    for (const PropertyBinding& binding : m_allBindings) {
+        stats.bindingBytes += MapNodeOverhead + sizeof(int) + sizeof(PropertyBinding) +
+                              stringPayload(binding.property) + stringPayload(binding.expression) +
+                              conditionPayload(binding.condition);
+    }
+    
+    // 依赖图只保存表达式节点索引
+    for (auto it = m_dependencies.constBegin(); it != m_dependencies.constEnd(); ++it) {
+        stats.dependencies += it.value().size();
+        stats.dependencyBytes += MapNodeOverhead + MemoryStats::sizeOf(it.key()) +
+                                 sizeof(QList<int>) + it.value().size() * sizeof(void*);
+    }
+    
+    // 共享表达式节点
+    stats.expressions = m_expressions.size();
+    stats.expressionBytes = m_expressions.capacity() * sizeof(SharedExpression);
+    for (const SharedExpression& node : m_expressions) {
+        stats.expressionBytes += stringPayload(node.expression) +
+                                 stringListBytes(node.variables) - qint64(sizeof(QStringList)) +
+                                 node.leafIds.capacity() * sizeof(int) +
+                                 node.bindings.size() * sizeof(void*);
+    }
+    for (auto it = m_expressionIndex.constBegin(); it != m_expressionIndex.constEnd(); ++it) {
+        stats.expressionBytes += HashNodeOverhead + MemoryStats::sizeOf(it.key()) + sizeof(int);
+    }
+    
+    // q-for 模板
+    stats.templates = m_generalQForBindings.size() + m_qforBindings.size();
+    for (const auto& holder : m_generalQForBindings) {
+        const GeneralQForBinding& binding = *holder;
+        stats.templateBytes += sizeof(GeneralQForBinding) + stringPayload(binding.templateXml) +
+                               binding.renderedWidgets.size() * sizeof(void*);
+        for (const QByteArray& key : binding.renderedKeys) {
+            stats.templateBytes += sizeof(void*) + key.capacity();
+        }
+        if (!binding.sourceField.isEmpty()) {
+            stats.listItems += binding.items.size();
+            stats.listDataBytes += MemoryStats::sizeOf(QVariant(binding.items));
+        }
+    }
+    for (const QForBinding& binding : m_qforBindings) {
+        stats.templateBytes += sizeof(QForBinding) + stringPayload(binding.textTemplate) +
+                               stringPayload(binding.valTemplate);
+    }
+    
+    // q-for 数据源
+    for (auto it = m_listData.constBegin(); it != m_listData.constEnd(); ++it) {
+        stats.listItems += it.value().size();
+        stats.listDataBytes += MapNodeOverhead + MemoryStats::sizeOf(it.key()) +
+                               MemoryStats::sizeOf(QVariant(it.value()));
+    }
+    
+    // 上下文知道的组件
+    QSet<QWidget*> widgets;
+    for (const QList<BoundWidget>& bound : m_widgets) {
+        for (const BoundWidget& entry : bound) {
+            widgets.insert(entry.widget);
+        }
+    }
+    for (const PropertyBinding& binding : m_allBindings) {
+        widgets.insert(binding.widget);
+    }
+    for (const auto& binding : m_generalQForBindings) {
+        for (QWidget* rendered : binding->renderedWidgets) {
+            widgets.insert(rendered);
+        }
+    }
+    widgets.remove(nullptr);
+    stats.widgets = widgets.size();
+    stats.widgetBytes = qint64(stats.widgets) * MemoryStats::EstimatedWidgetBytes;
+    
+    return stats;
+}
+
+// ========== 记录 ==========
+
+bool QuikContext::startRecording(const QString& filePath) {
+    std::unique_ptr<QuikRecorder> recorder(new QuikRecorder);
+    if (!recorder->open(filePath)) {
+        return false;
+    }
+    
+    // 初始状态：数据源在前（q-for 渲染出的组件可能注册变量），变量在后；计算变量由回放端重新计算
+    for (auto it = m_listData.constBegin(); it != m_listData.constEnd(); ++it) {
+        recorder->recordListData(it.key(), QVariantList(), it.value());
+    }
+    for (auto it = m_values.constBegin(); it != m_values.constEnd(); ++it) {
+        if (!m_computed.contains(it.key())) {
+            recorder->recordValue(it.key(), it.value());
+        }
+    }
+    
+    m_recorder = std::move(recorder);
+    qDebug() << "[Quik] Recording variable changes to" << filePath;
+    return true;
+}
+
+void QuikContext::stopRecording() {
+    if (m_recorder) {
+        m_recorder->close();
+        m_recorder.reset();
+    }
+}
+
+// ========== 输入延迟 ==========
+
+void QuikContext::setLatencyMonitorEnabled(bool enabled) {
+    m_latencyMonitor = enabled;
+    if (enabled && !m_latencyClock.isValid()) {
+        m_latencyClock.start();
+    }
+    if (!enabled) {
+        m_pendingInputs.clear();
+    }
+}
+
+void QuikContext::markInput(const QString& name) {
+    // 连续的信号（如拖动滑块）以第一个未完成的信号为起点
+    if (!m_pendingInputs.contains(name)) {
+        m_pendingInputs.insert(name, m_latencyClock.nsecsElapsed());
+    }
+}
+
+void QuikContext::finishInputPropagation(const QStringList& names) {
+    const qint64 now = m_latencyClock.nsecsElapsed();
+    
+    for (const QString& name : names) {
+        // 起点已被记录或清除（如期间关闭了监测）的输入不产生样本
+        auto start = m_pendingInputs.find(name);
+        if (start == m_pendingInputs.end()) {
+            continue;
+        }
+        const qint64 inputNs = start.value();
+        m_pendingInputs.erase(start);
+        m_latency[name].propagate.add((now - inputNs) / 1000);
+        
+        // 等待输入组件所在窗口的下一次绘制
+        QWidget* widget = getWidget(name);
+        QWidget* window = widget ? widget->window() : nullptr;
+        if (!window) {
+            continue;
+        }
+        
+        auto it = m_awaitingPaint.find(window);
+        if (it == m_awaitingPaint.end()) {
+            it = m_awaitingPaint.insert(window, QList<PendingInput>());
+            window->installEventFilter(this);
+        }
+        PendingInput pending;
+        pending.name = name;
+        pending.inputNs = inputNs;
+        it.value().append(pending);
+    }
+}
+
+void QuikContext::finishInputPaint(QWidget* window) {
+    auto it = m_awaitingPaint.find(window);
+    if (it == m_awaitingPaint.end()) {
+        return;
+    }
+    const QList<PendingInput> inputs = it.value();
+    m_awaitingPaint.erase(it);
+    if (window) {
+        window->removeEventFilter(this);
+    }
+    
+    const qint64 now = m_latencyClock.nsecsElapsed();
+    for (const PendingInput& input : inputs) {
+        const qint64 latencyUs = (now - input.inputNs) / 1000;
+        m_latency[input.name].paint.add(latencyUs);
+        
+        if (m_latencyThresholdMs > 0 && latencyUs > qint64(m_latencyThresholdMs) * 1000) {
+            qWarning() << "[Quik] Slow input:" << input.name << "took" << latencyUs / 1000.0
+                       << "ms from signal to paint (threshold" << m_latencyThresholdMs << "ms)";
+        }
+    }
+}
+
+QList<LatencyStats> QuikContext::latencyStats() const {
+    QList<LatencyStats> result;
+    QStringList names = m_latency.keys();
+    names.sort();
+    for (const QString& name : names) {
+        const VariableLatency& latency = m_latency[name];
+        LatencyStats stats;
+        stats.name = name;
+        stats.samples = latency.propagate.count();
+        stats.propagateP50 = latency.propagate.percentile(0.5);
+        stats.propagateP99 = latency.propagate.percentile(0.99);
+        stats.paintP50 = latency.paint.percentile(0.5);
+        stats.paintP99 = latency.paint.percentile(0.99);
+        stats.paintMax = latency.paint.max();
+        result.append(stats);
+    }
+    return result;
+}
+
+void QuikContext::resetLatencyStats() {
+    m_latency.clear();
+}
+
+// ========== 性能计数 ==========
+
+ProfileReport QuikContext::profile() const {
+    ProfileReport report;
+    
+    for (auto it = m_bindingProfile.constBegin(); it != m_bindingProfile.constEnd(); ++it) {
+        auto binding = m_allBindings.constFind(it.key());
+        if (binding == m_allBindings.constEnd()) {
+            continue;
+        }
+        ProfileEntry entry;
+        entry.kind = ProfileEntry::Binding;
+        entry.name = binding.value().property;
+        entry.expression = binding.value().expression;
+        entry.widget = binding.value().widget;
+        entry.evaluations = it.value().evaluations;
+        entry.applied = it.value().applied;
+        entry.totalNs = it.value().totalNs;
+        entry.maxNs = it.value().maxNs;
+        report.entries.append(entry);
+    }
+    
+    for (auto it = m_watcherProfile.constBegin(); it != m_watcherProfile.constEnd(); ++it) {
+        ProfileEntry entry;
+        entry.kind = ProfileEntry::Watcher;
+        entry.name = it.key();
+        entry.site = m_watcherSites.value(it.key());
+        entry.evaluations = it.value().evaluations;
+        entry.applied = it.value().applied;
+        entry.totalNs = it.value().totalNs;
+        entry.maxNs = it.value().maxNs;
+        report.entries.append(entry);
+    }
+    
+    return report;
+}
+
+void QuikContext::resetProfile() {
+    m_bindingProfile.clear();
+    m_watcherProfile.clear();
+    m_watcherOverBudget.clear();
+}
+
+void ProfileReport::sortBy(SortKey key) {
+    std::stable_sort(entries.begin(), entries.end(),
+                     [key](const ProfileEntry& a, const ProfileEntry& b) {
+                         switch (key) {
+                         case ByEvaluations: return a.evaluations > b.evaluations;
+                         case ByApplied:     return a.applied > b.applied;
+                         case ByTotalTime:   return a.totalNs > b.totalNs;
+                         case ByMaxTime:     return a.maxNs > b.maxNs;
+                         }
+                         return false;
+                     });
+}
+
+QString ProfileReport::toString(int limit) const {
+    QString text = QString("%1 %2 %3 %4 %5  %6\n")
+                       .arg("kind", -8).arg("evals", 8).arg("applied", 8)
+                       .arg("total us", 10).arg("max us", 8).arg("target");
+    int count = (limit > 0) ? qMin(limit, entries.size()) : entries.size();
+    for (int i = 0; i < count; ++i) {
+        const ProfileEntry& entry = entries.at(i);
+        QString target = (entry.kind == ProfileEntry::Binding)
+                             ? QString("%1=\"%2\"").arg(entry.name, entry.expression)
+                             : QString("watch(%1) @ %2").arg(entry.name, entry.site.toString());
+        text += QString("%1 %2 %3 %4 %5  %6\n")
+                    .arg(entry.kind == ProfileEntry::Binding ? "binding" : "watcher", -8)
+                    .arg(entry.evaluations, 8)
+                    .arg(entry.applied, 8)
+                    .arg(entry.totalNs / 1000.0, 10, 'f', 1)
+                    .arg(entry.maxNs / 1000.0, 8, 'f', 1)
+                    .arg(target);
+    }
+    return text;
+}
+
+// ========== 计算值 ==========
+
+void QuikContext::registerComputed(const QString& name, const QString& expression) {
+    if (name.isEmpty() || expression.isEmpty()) {
+        qWarning() << "[Quik] Computed requires both var and expr";
+        return;
+    }
+    
+    ComputedVariable computed;
+    computed.expression = expression;
+    computed.inputs = ExpressionParser::extractVariables(expression);
+    m_computed[name] = computed;
+    
+    rebuildComputedOrder();
+    
+    qDebug() << "[Quik] Registered computed:" << name << "=" << expression << "inputs:" << computed.inputs;
+    
+    // 立即求值（输入可能尚未注册，构建完成时还会整体求值一次）
+    if (m_computedOrder.contains(name)) {
+        QVariant value = ExpressionParser::evaluateArithmetic(expression, m_values);
+        if (m_values.value(name) != value) {
+            m_values[name] = value;
+            markDirty(name);
+            propagate();
+        }
+    }
+}
+
+void QuikContext::rebuildComputedOrder() {
+    // Kahn 拓扑排序：只统计计算变量之间的依赖边
+    QMap<QString, int> indegree;
+    QMap<QString, QStringList> dependents;
+    m_computedInputs.clear();
+    
+    for (auto it = m_computed.constBegin(); it != m_computed.constEnd(); ++it) {
+        indegree[it.key()];
+        for (const QString& input : it.value().inputs) {
+            m_computedInputs.insert(input);
+            if (m_computed.contains(input)) {
+                ++indegree[it.key()];
+                dependents[input].append(it.key());
+            }
+        }
+    }
+    
+    QStringList ready;
+    for (auto it = indegree.constBegin(); it != indegree.constEnd(); ++it) {
+        if (it.value() == 0) ready.append(it.key());
+    }
+    
+    m_computedOrder.clear();
+    while (!ready.isEmpty()) {
+        QString name = ready.takeFirst();
+        m_computedOrder.append(name);
+        for (const QString& dependent : dependents.value(name)) {
+            if (--indegree[dependent] == 0) {
+                ready.append(dependent);
+            }
+        }
+    }
+    
+    // 剩余的变量处于循环依赖中，不参与求值
+    if (m_computedOrder.size() < m_computed.size()) {
+        QStringList cyclic;
+        for (auto it = m_computed.constBegin(); it != m_computed.constEnd(); ++it) {
+            if (!m_computedOrder.contains(it.key())) cyclic.append(it.key());
+        }
+        qWarning() << "[Quik] Cyclic dependency between computed variables:" << cyclic.join(", ");
+    }
+}
+
+QStringList QuikContext::recomputeComputed(const QStringList& changedInputs) {
+    QSet<QString> changed;
+    for (const QString& input : changedInputs) {
+        changed.insert(input);
+    }
+    
+    // 拓扑顺序保证每个计算值最多求值一次，且其输入都已是最新值
+    QStringList updated;
+    for (const QString& name : m_computedOrder) {
+        const ComputedVariable& computed = m_computed[name];
+        
+        bool affected = false;
+        for (const QString& input : computed.inputs) {
+            if (changed.contains(input)) {
+                affected = true;
+                break;
+            }
+        }
+        if (!affected) continue;
+        
+        // 值未变化时不再向下游传播（记忆化）
+        QVariant value = ExpressionParser::evaluateArithmetic(computed.expression, m_values);
+        if (m_values.value(name) != value) {
+            m_values[name] = value;
+            changed.insert(name);
+            updated.append(name);
+        }
+    }
+    return updated;
+}
+
+QStringList QuikContext::recomputeAllComputed() {
+    QStringList updated;
+    for (const QString& name : m_computedOrder) {
+        QVariant value = ExpressionParser::evaluateArithmetic(m_computed[name].expression, m_values);
+        if (m_values.value(name) != value) {
+            m_values[name] = value;
+            updated.append(name);
+        }
+    }
+    return updated;
+}
+
+// ========== 输入校验 ==========
+
+// 验证错误提示文本（集中管理，便于国际化）
+// 注意：如需中文，请确保源文件保存为UTF-8 with BOM编码
+namespace ValidationMessages {
+    static QString required()         { return QStringLiteral("Required"); }
+    static QString minValue(double v) { return QString("Min: %1").arg(v); }
+    static QString maxValue(double v) { return QString("Max: %1").arg(v); }
+    static QString invalidFormat()    { return QStringLiteral("Invalid"); }
+    static QString invalidNumber()    { return QStringLiteral("Invalid number"); }
+}
+
+QString ValidationRule::check(const QString& text) const {
+    // 必填验证
+    if (required && text.isEmpty()) {
+        return errorMsg.isEmpty() ? ValidationMessages::required() : errorMsg;
+    }
+    
+    // 数值范围验证
+    if (!text.isEmpty() && (valid == "double" || valid == "int")) {
+        bool ok;
+        double val = text.toDouble(&ok);
+        if (!ok) {
+            // 转换失败（数值过大或格式错误）- 始终使用内置提示
+            return ValidationMessages::invalidNumber();
+        } else if (val < min) {
+            return errorMsg.isEmpty() ? ValidationMessages::minValue(min) : errorMsg;
+        } else if (val > max) {
+            return errorMsg.isEmpty() ? ValidationMessages::maxValue(max) : errorMsg;
+        }
+        return QString();
+    }
+    
+    // 正则验证
+    if (!pattern.pattern().isEmpty() && !text.isEmpty() && !pattern.match(text).hasMatch()) {
+        return errorMsg.isEmpty() ? ValidationMessages::invalidFormat() : errorMsg;
+    }
+    return QString();
+}
+
+// ========== 无界面模型 ==========
+
+void QuikContext::registerValue(const QString& name, const QVariant& defaultValue) {
+    if (name.isEmpty() || m_computed.contains(name) || m_values.contains(name)) {
+        return;
+    }
+    m_values.insert(name, defaultValue);
+}
+
+void QuikContext::registerField(const QString& field, const QString& parentField) {
+    if (field.isEmpty()) {
+        return;
+    }
+    if (!m_fields.contains(field)) {
+        m_fieldOrder.append(field);
+    }
+    m_fields[field].parent = parentField;
+}
+
+void QuikContext::bindField(const QString& field, const QString& property, const QString& expression) {
+    if (field.isEmpty() || expression.isEmpty()) {
+        return;
+    }
+    if (!m_fields.contains(field)) {
+        registerField(field);
+    }
+    
+    // 字面值直接写入状态，不进入依赖图
+    if (!ExpressionParser::isExpression(expression)) {
+        bool value = expression == "true" || expression == "1";
+        if (property == "visible") {
+            m_fields[field].visible = value;
+        } else if (property == "enabled") {
+            m_fields[field].enabled = value;
+        }
+        return;
+    }
+    
+    PropertyBinding binding;
+    binding.field = field;
+    binding.property = property;
+    binding.expression = expression;
+    addBinding(binding);
+}
+
+void QuikContext::setFieldValidation(const QString& field, const ValidationRule& rule) {
+    if (field.isEmpty()) {
+        return;
+    }
+    if (!m_fields.contains(field)) {
+        registerField(field);
+    }
+    m_fields[field].rule = rule;
+}
+
+bool QuikContext::isFieldVisible(const QString& field) const {
+    for (auto it = m_fields.constFind(field); it != m_fields.constEnd(); it = m_fields.constFind(it->parent)) {
+        if (!it->visible) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool QuikContext::isFieldEnabled(const QString& field) const {
+    for (auto it = m_fields.constFind(field); it != m_fields.constEnd(); it = m_fields.constFind(it->parent)) {
+        if (!it->enabled) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QMap<QString, QString> QuikContext::validationErrors() const {
+    QMap<QString, QString> errors;
+    for (const QString& field : m_fieldOrder) {
+        const ValidationRule& rule = m_fields.constFind(field)->rule;
+        if (rule.isEmpty() || !isFieldActive(field)) {
+            continue;
+        }
+        QString error = rule.check(m_values.value(field).toString());
+        if (!error.isEmpty()) {
+            errors.insert(field, error);
+        }
+    }
+    return errors;
+}
+
+BatchMask QuikContext::evaluateFieldActive(const QString& field, const BatchColumns& columns) const {
+    BatchMask active(columns.rows(), true);
+    
+    for (auto it = m_fields.constFind(field); it != m_fields.constEnd(); it = m_fields.constFind(it->parent)) {
+        bool visibleBound = false;
+        bool enabledBound = false;
+        for (const PropertyBinding& binding : m_allBindings) {
+            if (binding.widget || binding.field != it.key()) {
+                continue;
+            }
+            visibleBound |= binding.property == "visible";
+            enabledBound |= binding.property == "enabled";
+            active &= BatchEvaluator::evaluate(ExpressionParser::compile(binding.expression), columns);
+        }
+        
+        // 没有绑定表达式的属性是字面值，与记录无关
+        if ((!visibleBound && !it->visible) || (!enabledBound && !it->enabled)) {
+            return BatchMask(columns.rows(), false);
+        }
+    }
+    return active;
+}
+
+BatchMask QuikContext::evaluateFieldValid(const QString& field, const BatchColumns& columns) const {
+    auto it = m_fields.constFind(field);
+    if (it == m_fields.constEnd() || it->rule.isEmpty()) {
+        return BatchMask(columns.rows(), true);
+    }
+    
+    BatchMask valid = BatchEvaluator::validate(it->rule, field, columns);
+    valid |= ~evaluateFieldActive(field, columns);
+    return valid;
+}
+
+// ========== 响应式更新 ==========
+
+void QuikContext::initializeBindings() {
+    QUIK_TRACE_SCOPE("initializeBindings");
+    
+    // 输入组件可能在 <Computed> 之后才注册，先整体求值一次计算变量
+    for (const QString& name : recomputeAllComputed()) {
+        markDirty(name);
+    }
+    propagate();
+    
+    qDebug() << "[Quik] Initializing" << m_allBindings.size() << "bindings from"
+             << m_expressions.size() << "shared expressions";
+    
+    ++m_evalEpoch;
+    beginLayoutBatch();
+    const QList<int> bindingIds = m_allBindings.keys();
+    for (int bindingId : bindingIds) {
+        applyBinding(bindingId);
+    }
+    endLayoutBatch();
+}
+
+QVariantMap QuikContext::getContext() const {
+    return m_values;
+}
+
+void QuikContext::onVariableChanged(const QString& name, const QVariant& value) {
+    qDebug() << "[Quik] Variable changed:" << name << "=" << value;
+    updateDependentBindings(QStringList(name));
+}
+
+void QuikContext::updateDependentBindings(const QStringList& varNames) {
+    // 新的一轮：每个表达式节点（含子条件）最多求值一次，结果分发到其所有绑定
+    ++m_evalEpoch;
+    
+    // 依赖多个已变化变量的表达式只收集一次
+    QList<int> expressionIds;
+    QSet<int> seen;
+    for (const QString& varName : varNames) {
+        for (int id : m_dependencies.value(varName)) {
+            if (!seen.contains(id)) {
+                seen.insert(id);
+                expressionIds.append(id);
+            }
+        }
+    }
+    
+    for (int id : expressionIds) {
+        const QList<int> bindingIds = m_expressions[id].bindings;
+        for (int bindingId : bindingIds) {
+            applyBinding(bindingId);
+        }
+    }
+}
+
+void QuikContext::applyBinding(int bindingId) {
+    auto it = m_allBindings.constFind(bindingId);
+    if (it == m_allBindings.constEnd()) {
+        return;
+    }
+    PropertyBinding binding = it.value();
+    if (!binding.widget) {
+        // 无界面模型：结果记录到字段状态
+        auto field = m_fields.find(binding.field);
+        if (field != m_fields.end()) {
+            bool result = evaluateExpression(binding.expressionId);
+            m_unsharedEvaluations += m_expressions[binding.expressionId].examined;
+            if (binding.property == "visible") {
+                field->visible = result;
+            } else if (binding.property == "enabled") {
+                field->enabled = result;
+            }
+        }
+        return;
+    }
+    
+    // 祖先被显式隐藏时写入没有可见效果，延后到祖先重新显示时再求值
+    if (QWidget* ancestor = hiddenAncestor(binding.widget)) {
+        deferBinding(ancestor, bindingId);
+        return;
+    }
+    
+    QElapsedTimer timer;
+    if (m_profiling) {
+        timer.start();
+    }
+    
+    // 通过共享节点求值（支持复合表达式 and/or），本轮已求值过则直接复用
+    bool result = evaluateExpression(binding.expressionId);
+    m_unsharedEvaluations += m_expressions[binding.expressionId].examined;
+    
+    bool changed = false;
+    if (binding.property == "visible") {
+        changed = binding.widget->isHidden() == result;
+        if (changed) {
+            suspendLayouts(binding.widget);
+        }
+        binding.widget->setVisible(result);
+    } else if (binding.property == "enabled") {
+        changed = binding.widget->testAttribute(Qt::WA_ForceDisabled) == result;
+        binding.widget->setEnabled(result);
+    }
+    
+    if (m_profiling) {
+        ProfileCounter& counter = m_bindingProfile[bindingId];
+        counter.record(timer.nsecsElapsed());
+        if (changed) {
+            ++counter.applied;
+        }
+    }
+    
+    qDebug() << "[Quik] Applied" << binding.property << "=" << result 
+             << "for expression:" << binding.expression;
+}
+
+// ========== 批量布局 ==========
+
+void QuikContext::beginLayoutBatch() {
+    ++m_layoutBatchDepth;
+}
+
+void QuikContext::suspendLayouts(QWidget* widget) {
+    if (!m_layoutBatching || m_layoutBatchDepth == 0) {
+        return;
+    }
+    
+    // 显示子组件时 Qt 会逐级激活祖先布局，禁用后这些激活都变成空操作
+    for (QWidget* ancestor = widget->parentWidget(); ancestor; ancestor = ancestor->parentWidget()) {
+        QLayout* layout = ancestor->layout();
+        if (layout && layout->isEnabled()) {
+            layout->setEnabled(false);
+            m_suspendedLayouts.append(layout);
+        }
+        if (ancestor->isWindow()) {
+            break;
+        }
+    }
+    
+    // 只暂停变化组件的最近公共祖先的重绘，恢复时只重绘这棵子树而不是整个窗口
+    // （布局移动的其他组件由几何变化各自重绘）。每个窗口一个根，新组件不在根下时上移到公共祖先
+    QWidget* parent = widget->parentWidget();
+    if (!parent || widget->isWindow()) {
+        return;
+    }
+    for (int i = 0; i < m_suspendedUpdates.size(); ++i) {
+        QWidget* root = m_suspendedUpdates.at(i);
+        if (!root || root->window() != parent->window()) {
+            continue;
+        }
+        if (root == parent || root->isAncestorOf(parent)) {
+            return;
+        }
+        QWidget* common = root->parentWidget();
+        while (common && common != parent && !common->isAncestorOf(parent)) {
+            common = common->parentWidget();
+        }
+        if (common && common->updatesEnabled()) {
+            // 先暂停外层，再清除内层的暂停标记，恢复外层时一并恢复
+            common->setUpdatesEnabled(false);
+            root->setUpdatesEnabled(true);
+            m_suspendedUpdates[i] = common;
+        }
+        return;
+    }
+    if (parent->updatesEnabled()) {
+        parent->setUpdatesEnabled(false);
+        m_suspendedUpdates.append(parent);
+    }
+}
+
+void QuikContext::endLayoutBatch() {
+    if (--m_layoutBatchDepth > 0) {
+        return;
+    }
+    if (m_suspendedLayouts.isEmpty() && m_suspendedUpdates.isEmpty()) {
+        return;
+    }
+    
+    QList<QPointer<QLayout>> layouts;
+    layouts.swap(m_suspendedLayouts);
+    QList<QPointer<QWidget>> roots;
+    roots.swap(m_suspendedUpdates);
     
-    if (isCompound) {
-        // 复合表达式：提取所有变量并添加依赖
-        QStringList vars = ExpressionParser::extractVariables(expression);
-        for (const QString& var : vars) {
-            m_dependencies[var].append(binding);
-            qDebug() << "[Quik] Tracking variable for compound expr:" << var;
+    for (const QPointer<QLayout>& layout : layouts) {
+        if (layout) {
+            layout->setEnabled(true);
         }
-        binding.condition.isValid = true;  // 标记为有效，但使用expression求值
-    } else {
-        // 简单表达式
-        binding.condition = ExpressionParser::parse(expression);
-        
-        if (!binding.condition.isValid) {
-            qWarning() << "[Quik] Failed to parse expression:" << expression;
-            return;
-        }
-        
-        // 添加到左侧变量的依赖列表
-        m_dependencies[binding.condition.variable].append(binding);
-        
-        // 如果右侧也是变量，也添加到右侧变量的依赖列表
-        if (binding.condition.isRightVariable && !binding.condition.compareVariable.isEmpty()) {
-            m_dependencies[binding.condition.compareVariable].append(binding);
-            qDebug() << "[Quik] Also tracking right variable:" << binding.condition.compareVariable;
+    }
+    
+    // 由内到外激活（先算子布局的尺寸提示），每个布局只计算一次
+    QVector<QPair<int, QLayout*>> byDepth;
+    for (const QPointer<QLayout>& layout : layouts) {
+        if (layout && layout->parentWidget()) {
+            int depth = 0;
+            for (QWidget* w = layout->parentWidget(); w; w = w->parentWidget()) {
+                ++depth;
+            }
+            byDepth.append(qMakePair(depth, layout.data()));
         }
     }
+    std::stable_sort(byDepth.begin(), byDepth.end(),
+                     [](const QPair<int, QLayout*>& a, const QPair<int, QLayout*>& b) {
+                         return a.first > b.first;
+                     });
+    for (const QPair<int, QLayout*>& entry : byDepth) {
+        entry.second->activate();
+    }
     
-    m_allBindings.append(binding);
+    for (const QPointer<QWidget>& root : roots) {
+        if (root) {
+            root->setUpdatesEnabled(true);
+        }
+    }
     
-    qDebug() << "[Quik] Bound" << property << "of widget to expression:" << expression;
+    qDebug() << "[Quik] Layout batch:" << layouts.size() << "layouts," << roots.size() << "repaint roots";
 }
 
-// ========== 响应式更新 ==========
-
-void QuikContext::initializeBindings() {
-    qDebug() << "[Quik] Initializing" << m_allBindings.size() << "bindings";
-    
-    for (const PropertyBinding& binding : m_allBindings) {
-        applyBinding(binding);
+QWidget* QuikContext::hiddenAncestor(QWidget* widget) const {
+    // 只看窗口内部：被 hide()/setVisible(false) 显式隐藏的祖先（窗口本身的显示状态不算）
+    for (QWidget* ancestor = widget->parentWidget(); ancestor && !ancestor->isWindow();
+         ancestor = ancestor->parentWidget()) {
+        if (ancestor->isHidden() && ancestor->testAttribute(Qt::WA_WState_ExplicitShowHide)) {
+            return ancestor;
+        }
     }
+    return nullptr;
 }
 
-QVariantMap QuikContext::getContext() const {
-    return m_values;
-}
-
-void QuikContext::onVariableChanged(const QString& name, const QVariant& value) {
-    qDebug() << "[Quik] Variable changed:" << name << "=" << value;
-    updateDependentBindings(name);
-}
-
-void QuikContext::updateDependentBindings(const QString& varName) {
-    const QList<PropertyBinding>& bindings = m_dependencies.value(varName);
-    
-    for (const PropertyBinding& binding : bindings) {
-        applyBinding(binding);
+void QuikContext::deferBinding(QWidget* ancestor, int bindingId) {
+    auto it = m_deferredBindings.find(ancestor);
+    if (it == m_deferredBindings.end()) {
+        // 祖先首次有延后的绑定：监听其重新显示和销毁
+        it = m_deferredBindings.insert(ancestor, QList<int>());
+        ancestor->installEventFilter(this);
+        connect(ancestor, &QObject::destroyed, this, [this, ancestor]() {
+            m_deferredBindings.remove(ancestor);
+        });
     }
+    if (!it.value().contains(bindingId)) {
+        it.value().append(bindingId);
+    }
+    ++m_deferredCount;
 }
 
-void QuikContext::applyBinding(const PropertyBinding& binding) {
-    if (!binding.widget) {
+void QuikContext::flushDeferredBindings(QWidget* ancestor) {
+    auto it = m_deferredBindings.find(ancestor);
+    if (it == m_deferredBindings.end()) {
         return;
     }
     
-    // 使用表达式字符串求值（支持复合表达式 and/or）
-    bool result = ExpressionParser::evaluate(binding.expression, m_values);
+    QList<int> bindingIds = it.value();
+    m_deferredBindings.erase(it);
+    ancestor->removeEventFilter(this);
+    disconnect(ancestor, &QObject::destroyed, this, nullptr);
     
-    if (binding.property == "visible") {
-        binding.widget->setVisible(result);
-    } else if (binding.property == "enabled") {
-        binding.widget->setEnabled(result);
-    }
+    qDebug() << "[Quik] Applying" << bindingIds.size() << "deferred bindings";
     
-    qDebug() << "[Quik] Applied" << binding.property << "=" << result 
-             << "for expression:" << binding.expression;
+    // 一次性应用；仍在其他隐藏祖先之下的绑定会再次延后
+    // 传播中（绑定显示了隐藏的祖先）值不会变化，沿用本轮已求值的结果，不使其失效
+    if (!m_propagating) {
+        ++m_evalEpoch;
+    }
+    beginLayoutBatch();
+    for (int bindingId : bindingIds) {
+        applyBinding(bindingId);
+    }
+    endLayoutBatch();
 }
 
-void QuikContext::autoConnectWidget(const QString& name, QWidget* widget) {
-    // QCheckBox
-    if (auto* checkBox = qobject_cast<QCheckBox*>(widget)) {
-        // 初始化值
-        m_values[name] = checkBox->isChecked() ? 1 : 0;
-        
-        // 连接信号
-        connect(checkBox, &QCheckBox::toggled, this, [this, name](bool checked) {
-            setValue(name, checked ? 1 : 0);
-        });
-        return;
+bool QuikContext::eventFilter(QObject* watched, QEvent* event) {
+    if (event->type() == QEvent::ShowToParent && watched->isWidgetType()) {
+        flushDeferredBindings(static_cast<QWidget*>(watched));
+    } else if (event->type() == QEvent::UpdateRequest && watched->isWidgetType()) {
+        // 窗口在处理 UpdateRequest 时绘制，处理完成后的下一次事件循环即为绘制完成
+        QPointer<QWidget> window = static_cast<QWidget*>(watched);
+        if (m_awaitingPaint.contains(window)) {
+            QTimer::singleShot(0, this, [this, window]() {
+                finishInputPaint(window);
+            });
+        }
     }
+    return QObject::eventFilter(watched, event);
+}
+
+void QuikContext::autoConnectWidget(const QString& name, const BoundWidget& bound) {
+    if (!bound.widget) return;
     
-    // QRadioButton
-    if (auto* radioButton = qobject_cast<QRadioButton*>(widget)) {
-        m_values[name] = radioButton->isChecked() ? 1 : 0;
-        
-        connect(radioButton, &QRadioButton::toggled, this, [this, name](bool checked) {
-            setValue(name, checked ? 1 : 0);
-        });
+    if (!bound.adapter) {
+        qDebug() << "[Quik] No auto-connect for widget type:" << bound.widget->metaObject()->className();
         return;
     }
     
-    // QComboBox - 特殊处理，使用itemData作为值
-    if (auto* comboBox = qobject_cast<QComboBox*>(widget)) {
-        // 初始化值（使用当前选中项的data，如果没有则用text）
-        QVariant data = comboBox->currentData();
-        m_values[name] = data.isValid() ? data : comboBox->currentText();
-        
-        connect(comboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
-                this, [this, name, comboBox](int index) {
-            QVariant data = comboBox->itemData(index);
-            setValue(name, data.isValid() ? data : comboBox->itemText(index));
-        });
-        return;
+    // 初始化值（只读组件如 QLabel/QProgressBar 也需要；计算变量的值由表达式决定）
+    if (bound.adapter->read && !m_computed.contains(name)) {
+        m_values[name] = bound.adapter->read(bound.widget);
     }
     
-    // QLineEdit
-    if (auto* lineEdit = qobject_cast<QLineEdit*>(widget)) {
-        m_values[name] = lineEdit->text();
-        
-        connect(lineEdit, &QLineEdit::textChanged, this, [this, name](const QString& text) {
-            setValue(name, text);
-        });
-        return;
-    }
+    // 写入处理：按 debounce/throttle 属性限制写入上下文的频率，组件本身保持实时
+    // 外层记录信号到达时间（延迟监测的起点，debounce 的等待也计入延迟）
+    WidgetAdapter::ChangeHandler write = createChangeHandler(name, bound);
+    WidgetAdapter::ChangeHandler handler = [this, name, write](const QVariant& value) {
+        if (m_latencyMonitor) {
+            markInput(name);
+        }
+        write(value);
+    };
     
-    // QSpinBox
-    if (auto* spinBox = qobject_cast<QSpinBox*>(widget)) {
-        m_values[name] = spinBox->value();
-        
-        connect(spinBox, QOverload<int>::of(&QSpinBox::valueChanged),
-                this, [this, name](int value) {
-            setValue(name, value);
-        });
-        return;
+    // commit="editingFinished"：只在提交信号触发时写入
+    QString commit = bound.widget->property("_Quik_commit").toString();
+    if (!commit.isEmpty()) {
+        if (commit == "editingFinished" && bound.adapter->connectCommitted && bound.adapter->read) {
+            const WidgetAdapter* adapter = bound.adapter;
+            QWidget* widget = bound.widget;
+            adapter->connectCommitted(widget, this, [adapter, widget, handler]() {
+                handler(adapter->read(widget));
+            });
+            return;
+        }
+        qWarning() << "[Quik] Unsupported commit mode" << commit << "for" << name
+                   << "- falling back to value change signal";
     }
     
-    // QDoubleSpinBox
-    if (auto* doubleSpinBox = qobject_cast<QDoubleSpinBox*>(widget)) {
-        m_values[name] = doubleSpinBox->value();
-        
-        connect(doubleSpinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
-                this, [this, name](double value) {
-            setValue(name, value);
-        });
-        return;
+    // 连接值变化信号
+    if (bound.adapter->connectChanged) {
+        bound.adapter->connectChanged(bound.widget, this, handler);
     }
+}
+
+WidgetAdapter::ChangeHandler QuikContext::createChangeHandler(const QString& name, const BoundWidget& bound) {
+    int debounceMs = bound.widget->property("_Quik_debounce").toInt();
+    int throttleMs = bound.widget->property("_Quik_throttle").toInt();
+    const WidgetAdapter* adapter = bound.adapter;
+    QWidget* widget = bound.widget;
     
-    // QSlider
-    if (auto* slider = qobject_cast<QSlider*>(widget)) {
-        m_values[name] = slider->value();
-        
-        connect(slider, &QSlider::valueChanged, this, [this, name](int value) {
-            setValue(name, value);
+    // debounce：停止变化 debounceMs 后写入一次
+    // 计时器归组件所有，写入时读取组件的最新值，避免覆盖期间由 C++ 设置的值
+    if (debounceMs > 0 && adapter->read) {
+        auto* timer = new QTimer(widget);
+        timer->setSingleShot(true);
+        timer->setInterval(debounceMs);
+        connect(timer, &QTimer::timeout, this, [this, name, adapter, widget]() {
+            setValue(name, adapter->read(widget));
         });
-        return;
-    }
-    
-    // QProgressBar - 只读显示，只需初始化值
-    if (auto* progressBar = qobject_cast<QProgressBar*>(widget)) {
-        m_values[name] = progressBar->value();
-        return;
+        return [timer](const QVariant&) {
+            timer->start();
+        };
     }
     
-    // QLabel - 只读显示，只需初始化值
-    if (auto* label = qobject_cast<QLabel*>(widget)) {
-        m_values[name] = label->text();
-        return;
+    // throttle：首次变化立即写入，之后每 throttleMs 最多写入一次（窗口结束时写入最新值）
+    if (throttleMs > 0 && adapter->read) {
+        auto* timer = new QTimer(widget);
+        timer->setSingleShot(true);
+        timer->setInterval(throttleMs);
+        auto hasPending = std::make_shared<bool>(false);
+        connect(timer, &QTimer::timeout, this, [this, name, adapter, widget, timer, hasPending]() {
+            if (*hasPending) {
+                *hasPending = false;
+                setValue(name, adapter->read(widget));
+                timer->start();
+            }
+        });
+        return [this, name, timer, hasPending](const QVariant& value) {
+            if (timer->isActive()) {
+                *hasPending = true;
+                return;
+            }
+            setValue(name, value);
+            timer->start();
+        };
     }
     
-    qDebug() << "[Quik] No auto-connect for widget type:" << widget->metaObject()->className();
+    return [this, name](const QVariant& value) {
+        setValue(name, value);
+    };
 }
 
 void QuikContext::syncWidgetFromValue(const QString& name, const QVariant& value) {
-    const QList<QWidget*>& widgets = m_widgets.value(name);
+    auto it = m_widgets.constFind(name);
+    if (it == m_widgets.constEnd()) {
+        return;
+    }
     
     // 同步所有绑定到该变量的组件
-    for (QWidget* widget : widgets) {
-        syncSingleWidget(widget, value);
+    const QList<BoundWidget>& widgets = it.value();
+    for (const BoundWidget& bound : widgets) {
+        syncSingleWidget(bound, value);
     }
     
     if (!widgets.isEmpty()) {
@@ -272,75 +1460,125 @@ void QuikContext::syncWidgetFromValue(const QString& name, const QVariant& value
     }
 }
 
-void QuikContext::syncSingleWidget(QWidget* widget, const QVariant& value) {
-    if (!widget) return;
+void QuikContext::syncSingleWidget(const BoundWidget& bound, const QVariant& value) {
+    if (!bound.widget || !bound.adapter || !bound.adapter->write) return;
     
     // 阻止信号，避免循环触发
-    widget->blockSignals(true);
-    
-    // QCheckBox
-    if (auto* checkBox = qobject_cast<QCheckBox*>(widget)) {
-        checkBox->setChecked(value.toInt() != 0);
-    }
-    // QRadioButton
-    else if (auto* radioButton = qobject_cast<QRadioButton*>(widget)) {
-        radioButton->setChecked(value.toInt() != 0);
-    }
-    // QComboBox - 根据itemData查找并选中
-    else if (auto* comboBox = qobject_cast<QComboBox*>(widget)) {
-        QString valStr = value.toString();
-        for (int i = 0; i < comboBox->count(); ++i) {
-            QVariant data = comboBox->itemData(i);
-            if ((data.isValid() && data.toString() == valStr) || 
-                comboBox->itemText(i) == valStr) {
-                comboBox->setCurrentIndex(i);
-                break;
-            }
-        }
-    }
-    // QLineEdit
-    else if (auto* lineEdit = qobject_cast<QLineEdit*>(widget)) {
-        lineEdit->setText(value.toString());
-    }
-    // QSpinBox
-    else if (auto* spinBox = qobject_cast<QSpinBox*>(widget)) {
-        spinBox->setValue(value.toInt());
-    }
-    // QDoubleSpinBox
-    else if (auto* doubleSpinBox = qobject_cast<QDoubleSpinBox*>(widget)) {
-        doubleSpinBox->setValue(value.toDouble());
-    }
-    // QSlider
-    else if (auto* slider = qobject_cast<QSlider*>(widget)) {
-        slider->setValue(value.toInt());
-    }
-    // QProgressBar
-    else if (auto* progressBar = qobject_cast<QProgressBar*>(widget)) {
-        progressBar->setValue(value.toInt());
-    }
-    // QLabel - 用于LabelList中的Item
-    else if (auto* label = qobject_cast<QLabel*>(widget)) {
-        label->setText(value.toString());
-    }
-    
-    widget->blockSignals(false);
+    bool wasBlocked = bound.widget->blockSignals(true);
+    bound.adapter->write(bound.widget, value);
+    bound.widget->blockSignals(wasBlocked);
 }
 
 // ========== 单变量监听 ==========
 
 void QuikContext::watch(const QString& name, std::function<void(const QVariant&)> callback) {
     m_watchers[name] = callback;
-    qDebug() << "[Quik] Watching variable:" << name;
+    
+    WatchSite site = WatchSite::current();
+    if (site.isValid()) {
+        m_watcherSites[name] = site;
+    } else {
+        m_watcherSites.remove(name);
+    }
+    qDebug() << "[Quik] Watching variable:" << name << "at" << site.toString();
 }
 
 void QuikContext::unwatch(const QString& name) {
     m_watchers.remove(name);
+    m_watcherSites.remove(name);
     qDebug() << "[Quik] Unwatched variable:" << name;
 }
 
+void QuikContext::invokeWatcher(const QString& name, const std::function<void(const QVariant&)>& callback,
+                                const QVariant& value) {
+    if (!m_profiling && m_watcherBudgetMs <= 0) {
+        callback(value);
+        return;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    callback(value);
+    const qint64 elapsedNs = timer.nsecsElapsed();
+    
+    ProfileCounter& counter = m_watcherProfile[name];
+    counter.record(elapsedNs);
+    ++counter.applied;
+    
+    if (m_watcherBudgetMs > 0 && elapsedNs > qint64(m_watcherBudgetMs) * 1000000) {
+        ++m_watcherOverBudget[name];
+        qWarning() << "[Quik] Slow watcher for" << name << "took" << elapsedNs / 1000000.0
+                   << "ms (budget" << m_watcherBudgetMs << "ms), registered at"
+                   << m_watcherSites.value(name).toString();
+    }
+}
+
+QList<WatcherStats> QuikContext::watcherStats() const {
+    QList<WatcherStats> result;
+    for (auto it = m_watcherProfile.constBegin(); it != m_watcherProfile.constEnd(); ++it) {
+        WatcherStats stats;
+        stats.name = it.key();
+        stats.site = m_watcherSites.value(it.key());
+        stats.calls = it.value().evaluations;
+        stats.overBudget = m_watcherOverBudget.value(it.key());
+        stats.totalNs = it.value().totalNs;
+        stats.maxNs = it.value().maxNs;
+        result.append(stats);
+    }
+    std::sort(result.begin(), result.end(), [](const WatcherStats& a, const WatcherStats& b) {
+        return a.totalNs > b.totalNs;
+    });
+    return result;
+}
+
+// ========== 监听注册位置 ==========
+
+namespace {
+
+WatchSite& currentWatchSite() {
+    // 每个线程各自注册（无界面模型可在工作线程中构建）
+    static thread_local WatchSite site;
+    return site;
+}
+
+} // anonymous namespace
+
+QString WatchSite::toString() const {
+    if (!file) {
+        return QStringLiteral("<unknown>");
+    }
+    QString path = QString::fromLocal8Bit(file);
+    int slash = qMax(path.lastIndexOf('/'), path.lastIndexOf('\\'));
+    return QString("%1:%2").arg(path.mid(slash + 1)).arg(line);
+}
+
+WatchSite WatchSite::current() {
+    return currentWatchSite();
+}
+
+WatchSiteScope::WatchSiteScope(const char* file, int line)
+    : m_previous(currentWatchSite())
+{
+    currentWatchSite().file = file;
+    currentWatchSite().line = line;
+}
+
+WatchSiteScope::WatchSiteScope(const WatchSite& site)
+    : m_previous(currentWatchSite())
+{
+    currentWatchSite() = site;
+}
+
+WatchSiteScope::~WatchSiteScope() {
+    currentWatchSite() = m_previous;
+}
+
 // ========== 循环渲染 (q-for) ==========
 
 void QuikContext::setListData(const QString& name, const QVariantList& items) {
+    if (m_recorder) {
+        m_recorder->recordListData(name, m_listData.value(name), items);
+    }
     m_listData[name] = items;
     updateQForBindings(name);
     updateGeneralQForBindings(name);  // 同时更新通用 q-for
@@ -365,6 +1603,8 @@ void QuikContext::registerQForBinding(QWidget* widget, const QString& listName,
 }
 
 void QuikContext::updateQForBindings(const QString& listName) {
+    QUIK_TRACE_SCOPE_DETAIL("q-for combo", listName);
+    
     QVariantList items = m_listData.value(listName);
     
     for (const QForBinding& binding : m_qforBindings) {
@@ -383,22 +1623,10 @@ void QuikContext::updateQForBindings(const QString& listName) {
             for (const QVariant& itemData : items) {
                 QVariantMap itemMap = itemData.toMap();
                 
-                QString text = binding.textTemplate;
-                QString val = binding.valTemplate;
-                
-                // 替换 $item.xxx
-                for (auto it = itemMap.begin(); it != itemMap.end(); ++it) {
-                    QString placeholder = QString("$%1.%2").arg(binding.itemVar).arg(it.key());
-                    text.replace(placeholder, it.value().toString());
-                    val.replace(placeholder, it.value().toString());
-                }
-                
-                // 替换索引变量 $idx
-                if (!binding.indexVar.isEmpty()) {
-                    QString indexPlaceholder = QString("$%1").arg(binding.indexVar);
-                    text.replace(indexPlaceholder, QString::number(idx));
-                    val.replace(indexPlaceholder, QString::number(idx));
-                }
+                QString text = ExpressionParser::substituteTemplate(binding.textTemplate, binding.itemVar,
+                                                                    itemMap, binding.indexVar, idx);
+                QString val = ExpressionParser::substituteTemplate(binding.valTemplate, binding.itemVar,
+                                                                   itemMap, binding.indexVar, idx);
                 
                 if (!val.isEmpty()) {
                     comboBox->addItem(text, val);
@@ -421,10 +1649,59 @@ void QuikContext::updateQForBindings(const QString& listName) {
 
 // ========== 通用 q-for 支持 ==========
 
+namespace {
+
+// 行标识：项数据相同（模板用到索引时源索引也相同）的行渲染结果相同，可以复用
+QByteArray qForRowKey(const QVariant& item, int index) {
+    QByteArray key;
+    QDataStream stream(&key, QIODevice::WriteOnly);
+    stream << qint32(index) << item;
+    return key;
+}
+
+// q-sort 比较：两侧都是数值时按数值，否则按字符串
+bool qForSortLess(const QVariant& a, const QVariant& b) {
+    bool aNumeric = false;
+    bool bNumeric = false;
+    double x = a.toDouble(&aNumeric);
+    double y = b.toDouble(&bNumeric);
+    if (aNumeric && bNumeric) {
+        return x < y;
+    }
+    return QString::compare(a.toString(), b.toString()) < 0;
+}
+
+// 最长递增子序列（忽略负值），返回每个位置是否在其中
+QVector<bool> longestIncreasing(const QVector<int>& values) {
+    QVector<int> tails;                     // tails[k]：长度为 k+1 的子序列末尾的位置
+    QVector<int> previous(values.size(), -1);
+    for (int i = 0; i < values.size(); ++i) {
+        if (values[i] < 0) continue;
+        auto pos = std::lower_bound(tails.begin(), tails.end(), values[i],
+                                    [&values](int index, int value) { return values[index] < value; });
+        const int length = int(pos - tails.begin());
+        previous[i] = length > 0 ? tails[length - 1] : -1;
+        if (length == tails.size()) {
+            tails.append(i);
+        } else {
+            tails[length] = i;
+        }
+    }
+    
+    QVector<bool> inSequence(values.size(), false);
+    for (int i = tails.isEmpty() ? -1 : tails.last(); i >= 0; i = previous[i]) {
+        inSequence[i] = true;
+    }
+    return inSequence;
+}
+
+} // anonymous namespace
+
 void QuikContext::registerGeneralQFor(const QString& listName, const QString& itemVar,
                                        const QString& indexVar, QWidget* container,
                                        const QString& templateXml,
-                                       std::function<QWidget*(const QString&, int, const QVariantMap&)> renderCallback) {
+                                       std::function<QWidget*(const QString&, int, const QVariantMap&)> renderCallback,
+                                       const GeneralQForOptions& options) {
     GeneralQForBinding binding;
     binding.listName = listName;
     binding.itemVar = itemVar;
@@ -432,63 +1709,339 @@ void QuikContext::registerGeneralQFor(const QString& listName, const QString& it
     binding.container = container;
     binding.templateXml = templateXml;
     binding.renderCallback = renderCallback;
-    m_generalQForBindings.append(binding);
+    binding.rebindCallback = options.rebindCallback;
+    binding.sourceField = options.sourceField;
+    binding.items = options.items;
+    binding.sourceDepth = options.sourceDepth;
+    binding.nestedFields = options.nestedFields;
+    binding.outerScopes = options.outerScopes;
+    const QString& filter = options.filter;
+    const QString& sort = options.sort;
+    
+    // q-filter：引用本层和外层循环变量以外的变量时，这些变量变化也会更新视图
+    if (!filter.trimmed().isEmpty()) {
+        binding.filter = ExpressionParser::compile(filter);
+        if (binding.filter.isValid()) {
+            auto isLoopVariable = [&](const QString& name) -> bool {
+                if (name == itemVar || name.startsWith(itemVar + ".")) return true;
+                if (!indexVar.isEmpty() && name == indexVar) return true;
+                for (const TemplateScope& scope : options.outerScopes) {
+                    if (name == scope.itemVar || name.startsWith(scope.itemVar + ".")) return true;
+                    if (!scope.indexVar.isEmpty() && name == scope.indexVar) return true;
+                }
+                return false;
+            };
+            for (const QString& name : binding.filter.variables()) {
+                if (!isLoopVariable(name)) binding.viewVariables.append(name);
+            }
+        } else {
+            qWarning() << "[Quik] Invalid q-filter for list" << listName << ":" << filter;
+        }
+    }
+    
+    // q-sort："$item.name" 或 "$item.name desc"
+    if (!sort.trimmed().isEmpty()) {
+        const QStringList parts = sort.simplified().split(QLatin1Char(' '));
+        const QString itemPrefix = "$" + itemVar + ".";
+        const bool validOrder = parts.size() == 1 ||
+                                (parts.size() == 2 && (parts[1] == "asc" || parts[1] == "desc"));
+        if (validOrder && parts[0].startsWith(itemPrefix) && parts[0].size() > itemPrefix.size()) {
+            binding.sortField = parts[0].mid(itemPrefix.size());
+            binding.sortDescending = parts.size() == 2 && parts[1] == "desc";
+        } else {
+            qWarning() << "[Quik] Invalid q-sort for list" << listName << ":" << sort;
+        }
+    }
+    
+    // 分页：页号变量变化时切换页面
+    if (options.pageSize > 0) {
+        binding.pageSize = options.pageSize;
+        binding.pageVariable = options.pageVariable;
+        if (!binding.pageVariable.isEmpty() && !binding.viewVariables.contains(binding.pageVariable)) {
+            binding.viewVariables.append(binding.pageVariable);
+        }
+    }
+    
+    auto holder = std::make_shared<GeneralQForBinding>(std::move(binding));
+    m_generalQForBindings.append(holder);
     
     qDebug() << "[Quik] Registered general q-for for list:" << listName;
     
-    // 如果数据源已存在，立即更新
-    if (m_listData.contains(listName)) {
-        updateGeneralQForBindings(listName);
+    // 如果数据源已存在（嵌套 q-for 的列表随外层项给出），立即更新
+    if (!holder->sourceField.isEmpty() || m_listData.contains(listName)) {
+        refreshGeneralQFor(holder);
     }
 }
 
 void QuikContext::updateGeneralQForBindings(const QString& listName) {
-    QVariantList items = m_listData.value(listName);
+    // 遍历副本：渲染模板时会注册或移除嵌套的 q-for（新注册的在注册时已渲染）
+    const QList<std::shared_ptr<GeneralQForBinding>> bindings = m_generalQForBindings;
+    for (const auto& binding : bindings) {
+        if (binding->listName == listName && binding->sourceField.isEmpty()) {
+            refreshGeneralQFor(binding);
+        }
+    }
+}
+
+void QuikContext::updateGeneralQForViews(const QStringList& changed) {
+    const QList<std::shared_ptr<GeneralQForBinding>> bindings = m_generalQForBindings;
+    for (const auto& binding : bindings) {
+        for (const QString& name : binding->viewVariables) {
+            if (changed.contains(name)) {
+                refreshGeneralQFor(binding);
+                break;
+            }
+        }
+    }
+}
+
+bool QuikContext::acceptsQForItem(const GeneralQForBinding& binding, const QVariantMap& item, int index) const {
+    if (!binding.filter.isValid()) return true;
     
-    for (GeneralQForBinding& binding : m_generalQForBindings) {
-        if (binding.listName != listName) continue;
-        if (!binding.container || !binding.renderCallback) continue;
-        
-        QLayout* layout = binding.container->layout();
-        if (!layout) continue;
-        
-        // 1. 删除旧的渲染组件并清理绑定
-        for (QWidget* widget : binding.renderedWidgets) {
-            cleanupWidgetBindings(widget);
+    // 本层的循环变量在前，之后由内向外查找外层行的作用域，最后是上下文变量
+    const QString itemPrefix = binding.itemVar + ".";
+    auto lookup = [&](const QString& name) -> QVariant {
+        if (name.startsWith(itemPrefix)) return item.value(name.mid(itemPrefix.size()));
+        if (!binding.indexVar.isEmpty() && name == binding.indexVar) return index;
+        for (const TemplateScope& scope : binding.outerScopes) {
+            if (name.size() > scope.itemVar.size() && name.startsWith(scope.itemVar) &&
+                name.at(scope.itemVar.size()) == QLatin1Char('.')) {
+                return scope.item.value(name.mid(scope.itemVar.size() + 1));
+            }
+            if (!scope.indexVar.isEmpty() && name == scope.indexVar) return scope.index;
+        }
+        return m_values.value(name);
+    };
+    
+    return binding.filter.evaluate([&](int, const Condition& condition) -> bool {
+        // 缺少字段的项不通过过滤，不逐项告警
+        QVariantMap context;
+        QVariant left = lookup(condition.variable);
+        if (!left.isValid()) return false;
+        context.insert(condition.variable, left);
+        if (condition.isRightVariable) {
+            QVariant right = lookup(condition.compareVariable);
+            if (!right.isValid()) return false;
+            context.insert(condition.compareVariable, right);
+        }
+        return ExpressionParser::evaluate(condition, context);
+    });
+}
+
+void QuikContext::refreshGeneralQFor(std::shared_ptr<GeneralQForBinding> holder) {
+    GeneralQForBinding& binding = *holder;
+    QUIK_TRACE_SCOPE_DETAIL("q-for render", binding.listName);
+    
+    if (!binding.container || !binding.renderCallback) return;
+    auto* layout = qobject_cast<QBoxLayout*>(binding.container->layout());
+    if (!layout) return;
+    
+    // 1. 计算视图：过滤后按排序字段稳定排序，元素为源索引
+    const QVariantList items = binding.sourceField.isEmpty() ? m_listData.value(binding.listName) : binding.items;
+    QVector<int> view;
+    view.reserve(items.size());
+    for (int i = 0; i < items.size(); ++i) {
+        if (acceptsQForItem(binding, items.at(i).toMap(), i)) {
+            view.append(i);
+        }
+    }
+    if (!binding.sortField.isEmpty()) {
+        QVector<QVariant> keys(items.size());
+        for (int index : view) {
+            keys[index] = items.at(index).toMap().value(binding.sortField);
+        }
+        const bool descending = binding.sortDescending;
+        std::stable_sort(view.begin(), view.end(), [&keys, descending](int a, int b) {
+            return descending ? qForSortLess(keys[b], keys[a]) : qForSortLess(keys[a], keys[b]);
+        });
+    }
+    const int matched = view.size();
+    if (binding.pageSize > 0) {
+        const int pages = qMax(1, (matched + binding.pageSize - 1) / binding.pageSize);
+        const int page = qBound(0, m_values.value(binding.pageVariable).toInt(), pages - 1);
+        view = view.mid(page * binding.pageSize, binding.pageSize);
+    }
+    
+    // 2. 按标识匹配已渲染的行（相同标识的多行按顺序匹配）
+    QHash<QByteArray, QList<int>> renderedRows;
+    for (int i = 0; i < binding.renderedKeys.size(); ++i) {
+        renderedRows[binding.renderedKeys.at(i)].append(i);
+    }
+    QVector<QByteArray> keys(view.size());
+    QVector<int> oldPosition(view.size(), -1);
+    for (int i = 0; i < view.size(); ++i) {
+        QVariant identity = items.at(view[i]);
+        if (!binding.nestedFields.isEmpty()) {
+            // 嵌套列表的变化由内层自己处理，外层行不必重建
+            QVariantMap item = identity.toMap();
+            for (const QString& field : binding.nestedFields) {
+                item.remove(field);
+            }
+            identity = item;
+        }
+        keys[i] = qForRowKey(identity, binding.indexVar.isEmpty() ? -1 : view[i]);
+        auto it = renderedRows.find(keys[i]);
+        if (it != renderedRows.end() && !it->isEmpty()) {
+            oldPosition[i] = it->takeFirst();
+        }
+    }
+    
+    // 3. 离开视图的行：先留作备用，可以改绑给进入视图的行
+    QVector<bool> kept(binding.renderedWidgets.size(), false);
+    for (int position : oldPosition) {
+        if (position >= 0) kept[position] = true;
+    }
+    QList<QWidget*> spare;
+    for (int i = 0; i < kept.size(); ++i) {
+        if (!kept[i]) {
+            QWidget* widget = binding.renderedWidgets.at(i);
             layout->removeWidget(widget);
-            widget->deleteLater();
+            spare.append(widget);
         }
-        binding.renderedWidgets.clear();
-        
-        // 2. 根据新数据渲染组件
-        int idx = 0;
-        for (const QVariant& itemData : items) {
-            QVariantMap itemMap = itemData.toMap();
-            
-            // 调用渲染回调创建组件
-            QWidget* widget = binding.renderCallback(binding.templateXml, idx, itemMap);
-            if (widget) {
-                layout->addWidget(widget);
-                binding.renderedWidgets.append(widget);
+    }
+    
+    // 4. 保留的行中旧位置构成最长递增子序列的原地不动，其余先移出布局
+    const QVector<bool> stable = longestIncreasing(oldPosition);
+    for (int i = 0; i < view.size(); ++i) {
+        if (oldPosition[i] >= 0 && !stable[i]) {
+            layout->removeWidget(binding.renderedWidgets.at(oldPosition[i]));
+        }
+    }
+    
+    // 绑定ID只增不减：此后注册的绑定都来自本次渲染或改绑的行
+    const int firstNewBindingId = m_nextBindingId;
+    
+    // 5. 按视图顺序放入移动的行和进入视图的行（此时布局中只剩原地不动的行，前面的行都已就位）
+    QList<QWidget*> widgets;
+    QList<QByteArray> renderedKeys;
+    QList<QWidget*> entered;
+    int moved = 0;
+    int rebound = 0;
+    for (int i = 0; i < view.size(); ++i) {
+        QWidget* widget = nullptr;
+        if (oldPosition[i] >= 0) {
+            widget = binding.renderedWidgets.at(oldPosition[i]);
+            if (!stable[i]) {
+                layout->insertWidget(widgets.size(), widget);
+                ++moved;
+            }
+            if (!binding.nestedFields.isEmpty()) {
+                updateNestedQFor(widget, items.at(view[i]).toMap());
+            }
+        } else {
+            const QVariantMap item = items.at(view[i]).toMap();
+            if (binding.rebindCallback && !spare.isEmpty()) {
+                widget = spare.takeFirst();
+                if (binding.rebindCallback(widget, binding.templateXml, view[i], item)) {
+                    ++rebound;
+                } else {
+                    discardQForRow(widget);
+                    widget = nullptr;
+                }
+            }
+            if (!widget) {
+                widget = binding.renderCallback(binding.templateXml, view[i], item);
             }
-            ++idx;
+            if (!widget) continue;
+            layout->insertWidget(widgets.size(), widget);
+            entered.append(widget);
         }
-        
-        qDebug() << "[Quik] Updated general q-for:" << listName << "rendered" << idx << "items";
-        
-        // 3. 应用新创建组件的绑定（确保 visible 等属性正确初始化）
-        for (const PropertyBinding& propBinding : m_allBindings) {
-            if (propBinding.widget && propBinding.widget->parent()) {
-                // 检查是否是新创建的组件（在 renderedWidgets 中或其子组件）
-                for (QWidget* rendered : binding.renderedWidgets) {
-                    if (propBinding.widget == rendered || rendered->isAncestorOf(propBinding.widget)) {
-                        applyBinding(propBinding);
-                        break;
-                    }
+        widgets.append(widget);
+        renderedKeys.append(keys[i]);
+    }
+    binding.renderedWidgets = widgets;
+    binding.renderedKeys = renderedKeys;
+    
+    // 6. 没有被复用的行：清理绑定并销毁
+    for (QWidget* widget : spare) {
+        discardQForRow(widget);
+    }
+    
+    qDebug() << "[Quik] Updated general q-for:" << binding.listName << "showing" << widgets.size()
+             << "of" << matched << "matching items (" << entered.size() << "entered," << rebound << "rebound,"
+             << spare.size() << "destroyed," << moved << "moved)";
+    
+    if (entered.isEmpty()) return;
+    
+    // 7. 应用进入视图的行的绑定（确保 visible 等属性正确初始化）
+    // 只遍历本次新注册的绑定，翻页的开销与页大小有关，与表单的绑定总数无关
+    ++m_evalEpoch;
+    beginLayoutBatch();
+    QList<int> bindingIds;
+    for (auto it = m_allBindings.lowerBound(firstNewBindingId); it != m_allBindings.end(); ++it) {
+        bindingIds.append(it.key());
+    }
+    for (int bindingId : bindingIds) {
+        QWidget* target = m_allBindings.value(bindingId).widget;
+        if (target && target->parent()) {
+            for (QWidget* rendered : entered) {
+                if (target == rendered || rendered->isAncestorOf(target)) {
+                    applyBinding(bindingId);
+                    break;
                 }
             }
         }
     }
+    endLayoutBatch();
+}
+
+void QuikContext::updateNestedQFor(QWidget* row, const QVariantMap& item) {
+    const QList<std::shared_ptr<GeneralQForBinding>> bindings = m_generalQForBindings;
+    for (const auto& holder : bindings) {
+        GeneralQForBinding& nested = *holder;
+        if (nested.sourceField.isEmpty() || !nested.container || !row->isAncestorOf(nested.container)) {
+            continue;
+        }
+        // 只处理直接嵌套的一层，更深的层由内层刷新时逐级传递
+        QWidget* owner = nested.container->parentWidget();
+        while (owner && owner != row && !owner->objectName().startsWith(QLatin1String("_qfor_"))) {
+            owner = owner->parentWidget();
+        }
+        if (owner != row) continue;
+        
+        // 保留的外层行只有嵌套字段变化，外层作用域中的项随之更新，供 q-filter 查找
+        if (!nested.outerScopes.isEmpty()) {
+            nested.outerScopes.first().item = item;
+        }
+        if (nested.sourceDepth != 0) continue;
+        QVariantList items = item.value(nested.sourceField).toList();
+        if (items != nested.items) {
+            nested.items = items;
+            refreshGeneralQFor(holder);
+        }
+    }
+}
+
+void QuikContext::discardQForRow(QWidget* row) {
+    // 行中嵌套的 q-for 随行销毁，不能留下指向已删除容器的绑定
+    // 正在遍历的副本中可能还有这些绑定，清空容器使其刷新时直接返回
+    for (int i = m_generalQForBindings.size() - 1; i >= 0; --i) {
+        GeneralQForBinding& binding = *m_generalQForBindings.at(i);
+        if (binding.container && (binding.container == row || row->isAncestorOf(binding.container))) {
+            binding.container = nullptr;
+            m_generalQForBindings.removeAt(i);
+        }
+    }
+    cleanupWidgetBindings(row);
+    row->deleteLater();
+}
+
+void QuikContext::releaseWidget(QWidget* widget) {
+    if (!widget) return;
+    
+    cleanupWidgetBindings(widget);
+    
+    // 值变化信号以上下文为接收者连接；debounce/throttle 的计时器归组件所有，断开后不再使用
+    QList<QWidget*> widgets = widget->findChildren<QWidget*>();
+    widgets.prepend(widget);
+    for (QWidget* w : widgets) {
+        disconnect(w, nullptr, this, nullptr);
+        for (QTimer* timer : w->findChildren<QTimer*>(QString(), Qt::FindDirectChildrenOnly)) {
+            if (disconnect(timer, nullptr, this, nullptr)) {
+                timer->deleteLater();
+            }
+        }
+    }
 }
 
 void QuikContext::cleanupWidgetBindings(QWidget* widget) {
@@ -501,29 +2054,36 @@ void QuikContext::cleanupWidgetBindings(QWidget* widget) {
     
     // 清理 m_widgets 中的注册
     for (auto it = m_widgets.begin(); it != m_widgets.end(); ) {
-        it.value().removeAll(widget);
-        if (it.value().isEmpty()) {
+        QList<BoundWidget>& widgets = it.value();
+        for (int i = widgets.size() - 1; i >= 0; --i) {
+            if (widgets[i].widget == widget) {
+                widgets.removeAt(i);
+            }
+        }
+        if (widgets.isEmpty()) {
             it = m_widgets.erase(it);
         } else {
             ++it;
         }
     }
     
-    // 清理 m_dependencies 中的绑定
-    for (auto it = m_dependencies.begin(); it != m_dependencies.end(); ++it) {
-        QList<PropertyBinding>& bindings = it.value();
-        for (int i = bindings.size() - 1; i >= 0; --i) {
-            if (bindings[i].widget == widget) {
-                bindings.removeAt(i);
-            }
+    // 清理 m_allBindings，表达式节点不再驱动任何绑定时移出依赖图
+    for (auto it = m_allBindings.begin(); it != m_allBindings.end(); ) {
+        if (it.value().widget != widget) {
+            ++it;
+            continue;
         }
-    }
-    
-    // 清理 m_allBindings
-    for (int i = m_allBindings.size() - 1; i >= 0; --i) {
-        if (m_allBindings[i].widget == widget) {
-            m_allBindings.removeAt(i);
+        
+        int exprId = it.value().expressionId;
+        SharedExpression& node = m_expressions[exprId];
+        node.bindings.removeOne(it.key());
+        if (node.bindings.isEmpty()) {
+            for (const QString& var : node.variables) {
+                m_dependencies[var].removeOne(exprId);
+            }
         }
+        m_bindingProfile.remove(it.key());
+        it = m_allBindings.erase(it);
     }
 }
 
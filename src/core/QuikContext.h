@@ -3,23 +3,264 @@
 
 #include "Quik/QuikAPI.h"
 #include "parser/ExpressionParser.h"
+#include "widget/WidgetAdapter.h"
+#include "core/MpscQueue.h"
+#include "core/LatencyHistogram.h"
 #include <QObject>
 #include <QWidget>
+#include <QLayout>
+#include <QPointer>
 #include <QVariantMap>
 #include <QMap>
+#include <QHash>
 #include <QSet>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <atomic>
 #include <functional>
+#include <memory>
+
+class QTimer;
 
 namespace Quik {
 
+class QuikRecorder;
+class BatchColumns;
+class BatchMask;
+
 /**
  * @brief 属性绑定信息
  */
 struct PropertyBinding {
-    QWidget* widget;            // 目标组件
+    QWidget* widget = nullptr;  // 目标组件（无界面模型中为空）
+    QString field;              // 无界面模型中的字段名
     QString property;           // 绑定的属性名 (visible, enabled, text等)
     QString expression;         // 表达式字符串
     Condition condition;        // 解析后的条件
+    int expressionId = -1;      // 共享表达式节点（相同表达式的绑定共用一个节点）
+};
+
+/**
+ * @brief 输入校验规则
+ * 
+ * 与 LineEdit 的 valid/min/max/required/pattern/errorMsg 属性一一对应，
+ * 界面中随输入校验，无界面模型中由 QuikContext::validationErrors() 统一校验。
+ */
+struct QUIK_API ValidationRule {
+    QString valid;                      // "int" / "double"，为空时不做数值检查
+    double min = -1e308;
+    double max = 1e308;
+    bool required = false;
+    QRegularExpression pattern;         // 只编译一次
+    QString errorMsg;                   // 自定义提示（数值格式错误时仍使用内置提示）
+    
+    /**
+     * @brief 是否没有任何规则
+     */
+    bool isEmpty() const { return valid.isEmpty() && !required && pattern.pattern().isEmpty(); }
+    
+    /**
+     * @brief 校验文本
+     * @return 错误提示，通过时为空
+     */
+    QString check(const QString& text) const;
+};
+
+/**
+ * @brief 监听的注册位置（源文件和行号）
+ * 
+ * 由 QUIK_WATCH 宏在注册期间设置，watch() 注册时记录，用于慢监听的定位。
+ */
+struct QUIK_API WatchSite {
+    const char* file = nullptr;
+    int line = 0;
+    
+    bool isValid() const { return file != nullptr; }
+    
+    /**
+     * @brief 格式化为 "文件名:行号"，未知时为 "<unknown>"
+     */
+    QString toString() const;
+    
+    /**
+     * @brief 当前正在注册的位置（不在 QUIK_WATCH 中时无效）
+     */
+    static WatchSite current();
+};
+
+/**
+ * @brief 在作用域内设置当前注册位置（供 QUIK_WATCH 使用）
+ */
+class QUIK_API WatchSiteScope {
+public:
+    WatchSiteScope(const char* file, int line);
+    explicit WatchSiteScope(const WatchSite& site);
+    ~WatchSiteScope();
+    
+    WatchSiteScope(const WatchSiteScope&) = delete;
+    WatchSiteScope& operator=(const WatchSiteScope&) = delete;
+    
+private:
+    WatchSite m_previous;
+};
+
+/**
+ * @brief 记录监听的注册位置
+ * 
+ * 包裹任意 watch 调用（QuikContext、XMLUIBuilder 或 QuikViewModel 的变量访问器）：
+ * @code
+ * QUIK_WATCH(volume.watch([&](int v) { progress = v; }));
+ * QUIK_WATCH(builder.watch("mode", onModeChanged));
+ * @endcode
+ */
+#define QUIK_WATCH(...) \
+    do { ::Quik::WatchSiteScope quikWatchSite_(__FILE__, __LINE__); __VA_ARGS__; } while (0)
+
+/**
+ * @brief 单个变量的监听耗时统计
+ */
+struct WatcherStats {
+    QString name;               // 变量名
+    WatchSite site;             // 注册位置
+    quint64 calls = 0;          // 调用次数
+    quint64 overBudget = 0;     // 超出预算的次数
+    qint64 totalNs = 0;         // 累计耗时（纳秒）
+    qint64 maxNs = 0;           // 单次最大耗时（纳秒）
+};
+
+/**
+ * @brief 绑定求值统计
+ * 
+ * 相同的表达式（及复合表达式中相同的子条件）在依赖图中只有一个节点，
+ * 每轮更新只求值一次再分发到所有绑定。evaluationsSaved 是与逐个绑定求值相比省去的条件求值次数。
+ * 位于被隐藏容器内的绑定不求值，延后到容器重新显示时应用（deferred）。
+ */
+struct BindingStats {
+    int bindings = 0;               // 属性绑定数
+    int sharedExpressions = 0;      // 去重后的表达式节点数（含子条件）
+    quint64 evaluations = 0;        // 实际求值的条件数
+    quint64 evaluationsSaved = 0;   // 因共享而省去的求值次数
+    quint64 deferred = 0;           // 因祖先隐藏而延后的绑定应用次数
+};
+
+/**
+ * @brief 内存占用统计
+ * 
+ * 字节数是估算值：按对象大小 + 堆上数据（字符串、列表、映射节点）累加，
+ * 隐式共享的数据按每个引用各计一次；组件按每个 EstimatedWidgetBytes 估算（不含样式、图标等）。
+ * 用于观察长时间运行时的增长趋势和对比优化效果，不是精确的分配量。
+ */
+struct QUIK_API MemoryStats {
+    static const int EstimatedWidgetBytes = 1024;   // QWidget + 私有数据的大致大小（64位）
+    
+    int variables = 0;          // 变量数
+    qint64 variableBytes = 0;
+    int bindings = 0;           // 属性绑定数
+    qint64 bindingBytes = 0;
+    int dependencies = 0;       // 依赖图中的 变量 → 表达式节点 条目数
+    qint64 dependencyBytes = 0;
+    int expressions = 0;        // 共享表达式节点数
+    qint64 expressionBytes = 0;
+    int templates = 0;          // q-for 模板数（含 ComboBox Choice 模板）
+    qint64 templateBytes = 0;
+    int listItems = 0;          // q-for 数据源的条目总数
+    qint64 listDataBytes = 0;
+    int widgets = 0;            // 组件数
+    qint64 widgetBytes = 0;
+    
+    /**
+     * @brief 总字节数
+     */
+    qint64 totalBytes() const {
+        return variableBytes + bindingBytes + dependencyBytes + expressionBytes +
+               templateBytes + listDataBytes + widgetBytes;
+    }
+    
+    /**
+     * @brief 格式化为多行文本
+     */
+    QString toString() const;
+    
+    /**
+     * @brief 估算字符串占用（对象 + 堆上数据）
+     */
+    static qint64 sizeOf(const QString& str);
+    
+    /**
+     * @brief 估算值占用（递归计算字符串、列表和映射）
+     */
+    static qint64 sizeOf(const QVariant& value);
+};
+
+/**
+ * @brief 单个变量的输入延迟统计（微秒）
+ * 
+ * 从组件发出值变化信号开始计时：
+ * propagate 为传播（计算值、同步、绑定、监听）结束，paint 为之后的下一次窗口绘制完成。
+ */
+struct LatencyStats {
+    QString name;               // 变量名
+    quint64 samples = 0;        // 样本数
+    qint64 propagateP50 = 0;
+    qint64 propagateP99 = 0;
+    qint64 paintP50 = 0;
+    qint64 paintP99 = 0;
+    qint64 paintMax = 0;
+};
+
+/**
+ * @brief 单个绑定或监听的性能计数
+ */
+struct QUIK_API ProfileEntry {
+    enum Kind {
+        Binding,    // 属性绑定（visible/enabled）
+        Watcher     // watch() 注册的监听
+    };
+    
+    Kind kind = Binding;
+    QString name;               // 绑定的属性名，或监听的变量名
+    QString expression;         // 绑定的表达式（监听为空）
+    QPointer<QWidget> widget;   // 绑定的目标组件（监听为空）
+    WatchSite site;             // 监听的注册位置（绑定为空）
+    quint64 evaluations = 0;    // 求值/调用次数
+    quint64 applied = 0;        // 实际改变组件属性的次数（监听等于调用次数）
+    qint64 totalNs = 0;         // 累计耗时（纳秒）
+    qint64 maxNs = 0;           // 单次最大耗时（纳秒）
+};
+
+/**
+ * @brief 性能报告
+ * 
+ * 使用示例：
+ * @code
+ * context->setProfilingEnabled(true);
+ * // ... 操作界面 ...
+ * ProfileReport report = context->profile();
+ * report.sortBy(ProfileReport::ByTotalTime);
+ * qDebug().noquote() << report.toString(10);
+ * @endcode
+ */
+struct QUIK_API ProfileReport {
+    enum SortKey {
+        ByEvaluations,
+        ByApplied,
+        ByTotalTime,
+        ByMaxTime
+    };
+    
+    QVector<ProfileEntry> entries;
+    
+    /**
+     * @brief 按指定字段降序排序
+     */
+    void sortBy(SortKey key);
+    
+    /**
+     * @brief 格式化为表格文本
+     * @param limit 最多输出的条目数，0表示全部
+     */
+    QString toString(int limit = 0) const;
 };
 
 /**
@@ -46,9 +287,60 @@ public:
      * @brief 设置变量值
      * @param name 变量名
      * @param value 变量值
+     * 
+     * 值立即生效，随后按轮传播：先按拓扑顺序更新计算值，再同步组件、
+     * 每个受影响的表达式求值一次，最后发出 variableChanged 并调用监听。
+     * 监听回调中的 setValue 不会递归传播，而是进入下一轮；
+     * 回调之间互相写入无法收敛时，超过轮数上限后停止并输出循环链。
      */
     void setValue(const QString& name, const QVariant& value);
     
+    /**
+     * @brief 从任意线程投递变量值（线程安全）
+     * @param name 变量名
+     * @param value 变量值
+     * 
+     * 值进入无锁队列，由GUI线程每个事件循环批量应用一次；
+     * 同一变量在一批内只保留最后一次写入，且两批之间至少间隔 postInterval 毫秒。
+     * 适用于工作线程高频上报进度/结果，调用方须保证上下文在投递期间存活。
+     * 
+     * 使用示例：
+     * @code
+     * QtConcurrent::run([context]() {
+     *     for (int i = 0; i <= 100000; ++i) {
+     *         context->postValue("progress", i * 100 / 100000);
+     *     }
+     * });
+     * @endcode
+     */
+    void postValue(const QString& name, const QVariant& value);
+    
+    /**
+     * @brief 设置投递值批量应用的最小间隔
+     * @param msec 间隔毫秒数，默认16（约一帧），0表示每个事件循环都应用
+     */
+    void setPostInterval(int msec);
+    
+    /**
+     * @brief 获取投递值批量应用的最小间隔
+     */
+    int postInterval() const { return m_postInterval; }
+    
+    /**
+     * @brief 设置是否批量应用可见性变化（默认开启）
+     * 
+     * 开启时一次传播中的所有 visible 变化共用一次布局计算：
+     * 期间禁用受影响的布局，并暂停变化组件的最近公共祖先的重绘，传播结束后统一激活，
+     * 只重绘该祖先所在的区域。
+     * 关闭时每个 setVisible 都会立即重新计算祖先布局（用于对比测试）。
+     */
+    void setLayoutBatching(bool enabled) { m_layoutBatching = enabled; }
+    
+    /**
+     * @brief 是否批量应用可见性变化
+     */
+    bool layoutBatching() const { return m_layoutBatching; }
+    
     /**
      * @brief 获取变量值
      * @param name 变量名
@@ -87,6 +379,228 @@ public:
      */
     void bindProperty(QWidget* widget, const QString& property, const QString& expression);
     
+    // ========== 计算值 ==========
+    
+    /**
+     * @brief 注册计算变量
+     * @param name 变量名
+     * @param expression 算术表达式，如 "$w * $h"
+     * 
+     * 计算值缓存在变量表中，只在输入变化时按拓扑顺序重新求值，
+     * 在任何绑定/监听被通知之前完成（无中间状态），可以像普通变量一样用于 visible/enabled。
+     * 对应 XML：<Computed var="area" expr="$w * $h"/>
+     */
+    void registerComputed(const QString& name, const QString& expression);
+    
+    /**
+     * @brief 检查变量是否是计算变量
+     */
+    bool isComputed(const QString& name) const { return m_computed.contains(name); }
+    
+    // ========== 无界面模型 ==========
+    
+    /**
+     * @brief 注册不关联组件的变量
+     * @param name 变量名
+     * @param defaultValue 初始值（变量已有值时保留原值）
+     *
+     * 用于 XMLUIBuilder::buildModel()：不创建组件，由 initializeBindings() 统一求值。
+     */
+    void registerValue(const QString& name, const QVariant& defaultValue);
+    
+    /**
+     * @brief 注册字段（无界面模型中代替组件作为绑定目标）
+     * @param field 字段名，通常是 var，无 var 的容器由构建器生成
+     * @param parentField 所在容器的字段名，容器不可见/禁用时其中的字段同样不可见/禁用
+     */
+    void registerField(const QString& field, const QString& parentField = QString());
+    
+    /**
+     * @brief 绑定字段的 visible/enabled
+     * @param field 字段名（未注册时自动注册为顶层字段）
+     * @param property "visible" 或 "enabled"
+     * @param expression 表达式，或字面值 "true"/"1"/"false"/"0"
+     */
+    void bindField(const QString& field, const QString& property, const QString& expression);
+    
+    /**
+     * @brief 设置字段的校验规则
+     */
+    void setFieldValidation(const QString& field, const ValidationRule& rule);
+    
+    /**
+     * @brief 获取所有字段（按注册顺序）
+     */
+    QStringList fields() const { return m_fieldOrder; }
+    
+    /**
+     * @brief 字段及其所有容器是否可见（未注册的字段视为可见）
+     */
+    bool isFieldVisible(const QString& field) const;
+    
+    /**
+     * @brief 字段及其所有容器是否可用（未注册的字段视为可用）
+     */
+    bool isFieldEnabled(const QString& field) const;
+    
+    /**
+     * @brief 字段是否生效（可见且可用）
+     */
+    bool isFieldActive(const QString& field) const { return isFieldVisible(field) && isFieldEnabled(field); }
+    
+    /**
+     * @brief 按当前变量值校验所有生效的字段
+     * @return 字段名到错误信息的映射，不可见或禁用的字段不参与校验
+     *
+     * 使用示例：
+     * @code
+     * XMLUIBuilder builder;
+     * builder.buildModelFromFile("MeshPanel.xml");
+     * builder.loadFromJson("case01.json");
+     * QuikContext* context = builder.context();
+     * for (const QString& field : context->fields()) {
+     *     qDebug() << field << (context->isFieldActive(field) ? "active" : "inactive");
+     * }
+     * qDebug() << context->validationErrors();
+     * @endcode
+     */
+    QMap<QString, QString> validationErrors() const;
+    
+    /**
+     * @brief 对多条记录批量求值字段是否生效
+     * @param field 字段名
+     * @param columns 按列存储的记录（见 BatchColumns）
+     * @return 字段及其所有容器都可见且可用的记录
+     * 
+     * 与逐条加载后调用 isFieldActive() 结果一致，但表达式按列向量化求值，适合大量参数记录。
+     * 计算变量不会重新计算，表达式用到时须作为普通列提供。
+     * 
+     * 使用示例：
+     * @code
+     * BatchColumns columns = BatchColumns::fromRecords(records, {"mode", "level"});
+     * BatchMask visible = context->evaluateFieldActive("refineLevel", columns);
+     * qDebug() << visible.count() << "of" << records.size() << "records use refineLevel";
+     * @endcode
+     */
+    BatchMask evaluateFieldActive(const QString& field, const BatchColumns& columns) const;
+    
+    /**
+     * @brief 对多条记录批量校验字段
+     * @return 没有该字段错误的记录（字段不生效或通过校验），与 validationErrors() 不含该字段一致
+     */
+    BatchMask evaluateFieldValid(const QString& field, const BatchColumns& columns) const;
+    
+    // ========== 统计 ==========
+    
+    /**
+     * @brief 获取绑定求值统计
+     * 
+     * 使用示例：
+     * @code
+     * BindingStats stats = context->bindingStats();
+     * qDebug() << stats.bindings << "bindings," << stats.sharedExpressions << "nodes,"
+     *          << stats.evaluationsSaved << "evaluations saved";
+     * @endcode
+     */
+    BindingStats bindingStats() const;
+    
+    /**
+     * @brief 清零求值计数
+     */
+    void resetBindingStats();
+    
+    /**
+     * @brief 获取内存占用统计
+     * 
+     * 组件只统计上下文知道的（注册了变量、有属性绑定或由 q-for 渲染的），
+     * XMLUIBuilder::memoryStats() 会改为统计整棵组件树。
+     */
+    MemoryStats memoryStats() const;
+    
+    /**
+     * @brief 开启/关闭输入延迟监测（默认关闭）
+     * 
+     * 开启后记录每个变量从组件信号到传播结束、再到下一次绘制完成的延迟。
+     * 
+     * 使用示例：
+     * @code
+     * context->setLatencyMonitorEnabled(true);
+     * context->setLatencyThreshold(50);    // 超过50ms时输出警告
+     * // ... 用户操作 ...
+     * for (const LatencyStats& stats : context->latencyStats()) {
+     *     qDebug() << stats.name << "p50" << stats.paintP50 << "us, p99" << stats.paintP99 << "us";
+     * }
+     * @endcode
+     */
+    void setLatencyMonitorEnabled(bool enabled);
+    
+    /**
+     * @brief 是否开启输入延迟监测
+     */
+    bool isLatencyMonitorEnabled() const { return m_latencyMonitor; }
+    
+    /**
+     * @brief 设置警告阈值：输入到绘制完成超过该值时输出警告
+     * @param msec 毫秒数，0表示不警告
+     */
+    void setLatencyThreshold(int msec) { m_latencyThresholdMs = msec; }
+    
+    /**
+     * @brief 获取各变量的延迟统计（按变量名排序）
+     */
+    QList<LatencyStats> latencyStats() const;
+    
+    /**
+     * @brief 清空延迟统计
+     */
+    void resetLatencyStats();
+    
+    /**
+     * @brief 开始把变量变化记录到文件（供 QuikReplayer 回放）
+     * @param filePath 记录文件路径
+     * @return 是否成功
+     * 
+     * 先写入当前所有变量和数据源作为初始状态，之后记录每次实际改变的值和 setListData 的差量。
+     * 
+     * 使用示例：
+     * @code
+     * if (qEnvironmentVariableIsSet("QUIK_RECORD")) {
+     *     builder.context()->startRecording(QString::fromLocal8Bit(qgetenv("QUIK_RECORD")));
+     * }
+     * @endcode
+     */
+    bool startRecording(const QString& filePath);
+    
+    /**
+     * @brief 停止记录并关闭文件
+     */
+    void stopRecording();
+    
+    /**
+     * @brief 是否正在记录
+     */
+    bool isRecording() const { return m_recorder != nullptr; }
+    
+    /**
+     * @brief 开启/关闭逐个绑定和监听的性能计数（默认关闭，关闭时没有计时开销）
+     */
+    void setProfilingEnabled(bool enabled) { m_profiling = enabled; }
+    
+    /**
+     * @brief 是否开启性能计数
+     */
+    bool isProfilingEnabled() const { return m_profiling; }
+    
+    /**
+     * @brief 获取性能报告（每个有计数的绑定/监听一条，未排序）
+     */
+    ProfileReport profile() const;
+    
+    /**
+     * @brief 清零性能计数
+     */
+    void resetProfile();
+    
     // ========== 响应式更新 ==========
     
     /**
@@ -122,6 +636,26 @@ public:
      */
     void unwatch(const QString& name);
     
+    /**
+     * @brief 设置单次监听回调的耗时预算
+     * @param msec 毫秒数，0表示不计时（默认）
+     * 
+     * 开启后每次回调都会计时，超出预算时输出变量名和注册位置（用 QUIK_WATCH 注册时可用）。
+     */
+    void setWatcherBudget(int msec) { m_watcherBudgetMs = msec; }
+    
+    /**
+     * @brief 获取监听耗时预算
+     */
+    int watcherBudget() const { return m_watcherBudgetMs; }
+    
+    /**
+     * @brief 获取各变量监听的累计耗时（按累计耗时降序）
+     * 
+     * 设置了预算或开启了性能计数时才有数据。
+     */
+    QList<WatcherStats> watcherStats() const;
+    
 signals:
     /**
      * @brief 变量值改变信号
@@ -138,25 +672,152 @@ public slots:
      */
     void onVariableChanged(const QString& name, const QVariant& value);
     
+protected:
+    /**
+     * @brief 监听被隐藏的祖先重新显示，应用延后的绑定
+     */
+    bool eventFilter(QObject* watched, QEvent* event) override;
+    
+private slots:
+    /**
+     * @brief 调度投递值的批量应用（GUI线程，按 postInterval 限速）
+     */
+    void schedulePostedValues();
+    
+    /**
+     * @brief 取出队列中所有投递值，合并后批量应用
+     */
+    void flushPostedValues();
+    
 private:
     /**
-     * @brief 更新依赖于指定变量的所有绑定
-     * @param varName 变量名
+     * @brief 更新依赖于指定变量的所有绑定（每个表达式只求值一次）
+     * @param varNames 已变化的变量
+     */
+    void updateDependentBindings(const QStringList& varNames);
+    
+    /**
+     * @brief 写入变量值并标记为脏（不传播）
+     * @return 值是否发生变化
+     */
+    bool assignValue(const QString& name, const QVariant& value);
+    
+    /**
+     * @brief 标记变量待传播
+     */
+    void markDirty(const QString& name);
+    
+    /**
+     * @brief 按轮传播所有脏变量，直到没有新的写入
+     */
+    void propagate();
+    
+    /**
+     * @brief 输出循环写入的诊断信息
+     */
+    void reportPropagationCycle();
+    
+    /**
+     * @brief 编译表达式并登记绑定（bindProperty 与 bindField 共用）
+     */
+    void addBinding(PropertyBinding binding);
+    
+    /**
+     * @brief 应用绑定到组件（祖先被隐藏时延后），无界面模型中记录到字段状态
+     * @param bindingId 绑定ID
+     */
+    void applyBinding(int bindingId);
+    
+    /**
+     * @brief 记录组件信号到达（延迟监测的起点）
+     */
+    void markInput(const QString& name);
+    
+    /**
+     * @brief 传播结束：记录传播延迟，等待下一次绘制
+     * @param names 本次传播中完成的输入变量
+     */
+    void finishInputPropagation(const QStringList& names);
+    
+    /**
+     * @brief 窗口绘制完成：记录等待该窗口的输入的绘制延迟
+     */
+    void finishInputPaint(QWidget* window);
+    
+    /**
+     * @brief 开始批量应用绑定（可嵌套）
+     */
+    void beginLayoutBatch();
+    
+    /**
+     * @brief 结束批量应用绑定，最外层结束时恢复重绘并统一激活布局
+     */
+    void endLayoutBatch();
+    
+    /**
+     * @brief 组件可见性即将改变：禁用祖先布局，暂停本批次变化组件的公共祖先的重绘
+     */
+    void suspendLayouts(QWidget* widget);
+    
+    /**
+     * @brief 查找组件最近的被显式隐藏的祖先（不含窗口）
+     * @return 祖先组件，没有则返回nullptr
+     */
+    QWidget* hiddenAncestor(QWidget* widget) const;
+    
+    /**
+     * @brief 记录延后的绑定，祖先重新显示时统一应用
+     */
+    void deferBinding(QWidget* ancestor, int bindingId);
+    
+    /**
+     * @brief 应用祖先下所有延后的绑定
+     */
+    void flushDeferredBindings(QWidget* ancestor);
+    
+    /**
+     * @brief 获取或创建表达式对应的共享节点
+     * @param compiled 已编译的表达式
+     * @return 节点索引
+     */
+    int internExpression(const CompiledExpression& compiled);
+    
+    /**
+     * @brief 获取或创建单个比较对应的共享节点
+     * @param condition 比较条件
+     * @return 节点索引
      */
-    void updateDependentBindings(const QString& varName);
+    int internCondition(const Condition& condition);
     
     /**
-     * @brief 应用绑定到组件
-     * @param binding 绑定信息
+     * @brief 求值共享节点（同一轮更新内结果复用）
+     * @param id 节点索引
+     * @return 求值结果
      */
-    void applyBinding(const PropertyBinding& binding);
+    bool evaluateExpression(int id);
+    
+    /**
+     * @brief 变量关联的组件及其适配器
+     */
+    struct BoundWidget {
+        QWidget* widget;                // 组件
+        const WidgetAdapter* adapter;   // registerVariable 时解析的适配器，无适配器时为空
+    };
     
     /**
      * @brief 自动连接组件的值变化信号
      * @param name 变量名
-     * @param widget 组件
+     * @param bound 组件及其适配器
+     */
+    void autoConnectWidget(const QString& name, const BoundWidget& bound);
+    
+    /**
+     * @brief 创建写入上下文的处理函数（处理 debounce/throttle 属性）
+     * @param name 变量名
+     * @param bound 组件及其适配器
+     * @return 值变化处理函数
      */
-    void autoConnectWidget(const QString& name, QWidget* widget);
+    WidgetAdapter::ChangeHandler createChangeHandler(const QString& name, const BoundWidget& bound);
     
     /**
      * @brief 从变量值同步更新UI组件（双向绑定：C++ → UI）
@@ -167,20 +828,151 @@ private:
     
     /**
      * @brief 同步单个组件的值
-     * @param widget 组件
+     * @param bound 组件及其适配器
      * @param value 变量值
      */
-    void syncSingleWidget(QWidget* widget, const QVariant& value);
+    void syncSingleWidget(const BoundWidget& bound, const QVariant& value);
+    
+    /**
+     * @brief 按拓扑顺序重新计算受影响的计算变量
+     * @param changedInputs 已改变的变量
+     * @return 值确实发生变化的计算变量（拓扑顺序）
+     */
+    QStringList recomputeComputed(const QStringList& changedInputs);
+    
+    /**
+     * @brief 重新计算所有计算变量（构建完成时调用）
+     * @return 值发生变化的计算变量
+     */
+    QStringList recomputeAllComputed();
+    
+    /**
+     * @brief 重建计算变量的拓扑顺序，检测循环依赖
+     */
+    void rebuildComputedOrder();
     
 private:
     QVariantMap m_values;                                    // 变量值存储
-    QMap<QString, QList<QWidget*>> m_widgets;                // 变量名 → 组件列表（支持多个组件绑定同一变量）
-    QMap<QString, QList<PropertyBinding>> m_dependencies;    // 变量名 → 依赖它的绑定列表
-    QList<PropertyBinding> m_allBindings;                    // 所有绑定
+    QMap<QString, QList<BoundWidget>> m_widgets;             // 变量名 → 组件列表（支持多个组件绑定同一变量）
+    QMap<QString, QList<int>> m_dependencies;                // 变量名 → 依赖它的表达式节点
+    QMap<int, PropertyBinding> m_allBindings;                // 绑定ID → 绑定
+    int m_nextBindingId = 0;
+    
+    // 共享表达式节点：相同的表达式/子条件只保存和求值一次
+    struct SharedExpression {
+        QString expression;         // 规范化后的表达式
+        QStringList variables;      // 依赖的变量
+        Condition condition;        // 单个比较（子条件节点）
+        CompiledExpression compiled;    // 表达式树（复合表达式节点）
+        QVector<int> leafIds;       // 树中每个比较对应的子条件节点
+        QList<int> bindings;        // 由该节点驱动的绑定ID
+        quint64 epoch = 0;          // 缓存结果所属的更新轮次
+        bool result = false;        // 缓存结果
+        int examined = 0;           // 上次求值实际检查的条件数（短路后）
+    };
+    QVector<SharedExpression> m_expressions;
+    QHash<QString, int> m_expressionIndex;                   // 规范表达式 → 节点索引
+    quint64 m_evalEpoch = 1;                                 // 更新轮次，轮次内节点结果可复用
+    quint64 m_evaluations = 0;                               // 实际求值的条件数
+    quint64 m_unsharedEvaluations = 0;                       // 逐个绑定求值时需要检查的条件数
+    
+    // 隐藏子树中延后的绑定：祖先重新显示（ShowToParent）时统一应用
+    QHash<QWidget*, QList<int>> m_deferredBindings;          // 隐藏的祖先 → 绑定ID
+    
+    // 无界面模型的字段
+    struct FieldState {
+        QString parent;             // 所在容器的字段名
+        bool visible = true;
+        bool enabled = true;
+        ValidationRule rule;
+    };
+    QHash<QString, FieldState> m_fields;
+    QStringList m_fieldOrder;
+    quint64 m_deferredCount = 0;
+    
+    // 性能计数（setProfilingEnabled 开启时记录）
+    struct ProfileCounter {
+        quint64 evaluations = 0;
+        quint64 applied = 0;
+        qint64 totalNs = 0;
+        qint64 maxNs = 0;
+        
+        void record(qint64 ns) {
+            ++evaluations;
+            totalNs += ns;
+            maxNs = qMax(maxNs, ns);
+        }
+    };
+    bool m_profiling = false;
+    QHash<int, ProfileCounter> m_bindingProfile;             // 绑定ID → 计数
+    QHash<QString, ProfileCounter> m_watcherProfile;         // 变量名 → 监听计数
+    
+    // 监听计时（预算 > 0 或开启性能计数时）
+    int m_watcherBudgetMs = 0;
+    QHash<QString, WatchSite> m_watcherSites;                // 变量名 → 注册位置
+    QHash<QString, quint64> m_watcherOverBudget;             // 变量名 → 超预算次数
+    
+    /**
+     * @brief 调用监听回调（按需计时并检查预算）
+     */
+    void invokeWatcher(const QString& name, const std::function<void(const QVariant&)>& callback,
+                       const QVariant& value);
+    
+    // 输入延迟监测
+    struct PendingInput {
+        QString name;
+        qint64 inputNs;
+    };
+    struct VariableLatency {
+        LatencyHistogram propagate;
+        LatencyHistogram paint;
+    };
+    bool m_latencyMonitor = false;
+    int m_latencyThresholdMs = 0;
+    QElapsedTimer m_latencyClock;
+    QHash<QString, qint64> m_pendingInputs;                  // 已收到信号、尚未传播完成的输入
+    QHash<QWidget*, QList<PendingInput>> m_awaitingPaint;    // 窗口 → 等待绘制的输入
+    QHash<QString, VariableLatency> m_latency;
+    
+    // 变量变化记录（startRecording）
+    std::unique_ptr<QuikRecorder> m_recorder;
+    
+    // 可见性变化的批量布局
+    bool m_layoutBatching = true;
+    int m_layoutBatchDepth = 0;
+    QList<QPointer<QWidget>> m_suspendedUpdates;             // 本批次暂停重绘的子树根（每个窗口一个）
+    QList<QPointer<QLayout>> m_suspendedLayouts;             // 本批次禁用的布局（由内到外）
     
     // 单变量监听
     QMap<QString, std::function<void(const QVariant&)>> m_watchers;  // 变量名 → 监听回调
     
+    // 传播
+    QStringList m_dirty;                    // 待传播的变量（按写入顺序）
+    QSet<QString> m_dirtySet;
+    bool m_propagating = false;             // 是否处于传播中（此时的写入进入下一轮）
+    QString m_activeSource;                 // 正在通知的变量（其监听中的写入来源）
+    QHash<QString, QString> m_writers;      // 变量 → 写入它的监听所属变量（循环诊断）
+    
+    // 计算变量
+    struct ComputedVariable {
+        QString expression;     // 算术表达式
+        QStringList inputs;     // 依赖的变量
+    };
+    QMap<QString, ComputedVariable> m_computed;          // 变量名 → 计算定义
+    QSet<QString> m_computedInputs;                      // 被任一计算变量依赖的变量
+    QStringList m_computedOrder;                         // 拓扑顺序（不含循环依赖的变量）
+    
+    // 跨线程投递 (postValue)
+    struct PostedValue {
+        QString name;
+        QVariant value;
+    };
+    MpscQueue<PostedValue> m_postQueue;             // 工作线程 → GUI线程
+    std::atomic<bool> m_postScheduled{false};       // 是否已调度批量应用
+    QTimer* m_postTimer = nullptr;                  // 限速计时器
+    QElapsedTimer m_lastPostFlush;                  // 上次批量应用的时间
+    int m_postInterval = 16;
+    
     // 循环渲染数据源 (q-for)
     QMap<QString, QVariantList> m_listData;
     
@@ -217,8 +1009,44 @@ public:
         QString indexVar;           // 索引变量名 (如 "idx")
         QWidget* container;         // 父容器
         QString templateXml;        // 模板 XML 字符串
-        QList<QWidget*> renderedWidgets;  // 已渲染的组件
+        QList<QWidget*> renderedWidgets;  // 已渲染的组件（按视图顺序）
+        QList<QByteArray> renderedKeys;   // 已渲染行的标识（项数据，模板用到索引时含源索引）
         std::function<QWidget*(const QString&, int, const QVariantMap&)> renderCallback;  // 渲染回调
+        std::function<bool(QWidget*, const QString&, int, const QVariantMap&)> rebindCallback;  // 复用行的回调（可为空）
+        CompiledExpression filter;  // q-filter（未设置时无效）
+        QString sortField;          // q-sort 的排序字段（$item.name 中的 name）
+        bool sortDescending = false;
+        int pageSize = 0;           // 每页行数，0 表示不分页
+        QString pageVariable;       // 页号变量（从 0 开始）
+        QStringList viewVariables;  // 视图依赖的上下文变量（q-filter 引用的变量和页号变量）
+        QString sourceField;        // 嵌套 q-for：列表来自外层项的该字段，此时使用 items 而不是数据源
+        QVariantList items;         // 嵌套 q-for 的列表
+        int sourceDepth = 0;        // 列表所在的外层，只有 0（直接外层）随保留的外层行更新
+        QStringList nestedFields;   // 本层项中作为嵌套 q-for 列表的字段（不计入行标识）
+        QVector<TemplateScope> outerScopes;  // 外层行的作用域（内层在前），q-filter 按项求值时查找外层循环变量
+    };
+    
+    /**
+     * @brief 通用 q-for 的视图选项
+     */
+    struct GeneralQForOptions {
+        QString filter;             // q-filter 表达式，如 "$item.enabled==1 and $showAll==0"，可引用上下文变量
+        QString sort;               // q-sort 排序字段，如 "$item.name" 或 "$item.name desc"
+        int pageSize = 0;           // page-size，0 表示不分页
+        QString pageVariable;       // page 绑定的页号变量（不含$，从 0 开始，超出范围时显示最后一页）
+        
+        /**
+         * 把已渲染的行改绑到另一项，成功返回 true；为空或返回 false 时销毁旧行并重新渲染。
+         * 参数与渲染回调相同，第一个参数是要复用的行。
+         */
+        std::function<bool(QWidget*, const QString&, int, const QVariantMap&)> rebindCallback;
+        
+        // 嵌套 q-for（在外层的行中注册）
+        QString sourceField;        // 列表来自外层项的字段，如 "field in group.fields" 中的 fields
+        QVariantList items;         // 外层项中该字段的当前值
+        int sourceDepth = 0;        // 字段所在的外层：0 为直接外层；更外层的字段不计入直接外层的嵌套字段，随那一层的行重建
+        QStringList nestedFields;   // 本层项中作为嵌套 q-for 列表的字段
+        QVector<TemplateScope> outerScopes;  // 外层行的作用域（内层在前），q-filter 可引用外层的循环变量和索引
     };
     
     /**
@@ -228,22 +1056,65 @@ public:
      * @param indexVar 索引变量名
      * @param container 父容器
      * @param templateXml 模板 XML
-     * @param renderCallback 渲染回调函数
+     * @param renderCallback 渲染回调函数，索引参数是项在数据源中的位置
+     * @param options 过滤、排序和分页
+     * 
+     * 数据源或视图依赖的上下文变量变化时增量更新：只渲染进入视图的行、销毁离开的行，
+     * 位置变化的行移动到新位置（不重新渲染），其余行保持不动。
+     * 分页时只渲染当前页的行；提供了 rebindCallback 时，离开视图的行改绑给进入视图的行，
+     * 翻页不会重建组件，组件数不超过 pageSize。
+     * 
+     * 嵌套的 q-for 由外层的行注册，列表可以是外层项的字段（options.sourceField）。
+     * 外层项只有这些字段变化时保留外层行，只更新对应的内层；外层行销毁时其中的内层绑定一并移除。
      */
     void registerGeneralQFor(const QString& listName, const QString& itemVar, 
                              const QString& indexVar, QWidget* container,
                              const QString& templateXml,
-                             std::function<QWidget*(const QString&, int, const QVariantMap&)> renderCallback);
+                             std::function<QWidget*(const QString&, int, const QVariantMap&)> renderCallback,
+                             const GeneralQForOptions& options = GeneralQForOptions());
+    
+    /**
+     * @brief 解除组件（含子组件）的变量注册、属性绑定和值变化连接
+     * @param widget 组件，本身保留，可重新注册到其他变量（q-for 复用行时使用）
+     */
+    void releaseWidget(QWidget* widget);
     
     /**
      * @brief 获取所有通用 q-for 绑定
      */
-    QList<GeneralQForBinding>& generalQForBindings() { return m_generalQForBindings; }
+    const QList<std::shared_ptr<GeneralQForBinding>>& generalQForBindings() const { return m_generalQForBindings; }
     
 private:
-    QList<GeneralQForBinding> m_generalQForBindings;
+    // 按指针保存：渲染行时会注册嵌套的 q-for，销毁行时会移除，正在刷新的绑定不能因此失效
+    QList<std::shared_ptr<GeneralQForBinding>> m_generalQForBindings;
     void updateGeneralQForBindings(const QString& listName);
     
+    /**
+     * @brief 重新计算 q-for 视图（过滤、排序）并增量更新渲染的行
+     * @param holder 刷新期间持有绑定，绑定在此期间被移除也不会失效
+     */
+    void refreshGeneralQFor(std::shared_ptr<GeneralQForBinding> holder);
+    
+    /**
+     * @brief 外层行保留时，把项中嵌套列表字段的新值交给行中的内层 q-for
+     */
+    void updateNestedQFor(QWidget* row, const QVariantMap& item);
+    
+    /**
+     * @brief 销毁 q-for 的行，并移除其中嵌套的 q-for 绑定
+     */
+    void discardQForRow(QWidget* row);
+    
+    /**
+     * @brief 更新 q-filter 引用了已变化变量的 q-for
+     */
+    void updateGeneralQForViews(const QStringList& changed);
+    
+    /**
+     * @brief 项是否通过 q-filter
+     */
+    bool acceptsQForItem(const GeneralQForBinding& binding, const QVariantMap& item, int index) const;
+    
     /**
      * @brief 清理与指定组件相关的所有绑定和注册
      * @param widget 要清理的组件
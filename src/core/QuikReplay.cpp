@@ -0,0 +1,241 @@
+#include "QuikReplay.h"
+#include <QTimer>
+#include <QDebug>
+
+namespace Quik {
+
+// ========== 记录 ==========
+
+bool QuikRecorder::open(const QString& filePath) {
+    close();
+    
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "[Quik] Cannot open recording file:" << filePath;
+        return false;
+    }
+    
+    m_stream.setDevice(&m_file);
+    m_stream.setVersion(QDataStream::Qt_5_6);
+    m_stream << Magic << Version;
+    
+    m_names.clear();
+    m_count = 0;
+    m_lastUs = 0;
+    m_clock.start();
+    return true;
+}
+
+void QuikRecorder::close() {
+    if (m_file.isOpen()) {
+        m_stream.setDevice(nullptr);
+        m_file.close();
+        qDebug() << "[Quik] Recording closed," << m_count << "records";
+    }
+}
+
+quint16 QuikRecorder::nameId(const QString& name) {
+    auto it = m_names.constFind(name);
+    if (it != m_names.constEnd()) {
+        return it.value();
+    }
+    quint16 id = quint16(m_names.size());
+    m_names.insert(name, id);
+    m_stream << quint8(DefineName) << id << name;
+    return id;
+}
+
+void QuikRecorder::writeTime() {
+    qint64 now = m_clock.nsecsElapsed() / 1000;
+    m_stream << quint32(qMin<qint64>(now - m_lastUs, 0xFFFFFFFF));
+    m_lastUs = now;
+}
+
+void QuikRecorder::recordValue(const QString& name, const QVariant& value) {
+    if (!isOpen()) return;
+    
+    quint16 id = nameId(name);
+    m_stream << quint8(Value);
+    writeTime();
+    m_stream << id << value;
+    ++m_count;
+}
+
+void QuikRecorder::recordListData(const QString& name, const QVariantList& before, const QVariantList& after) {
+    if (!isOpen()) return;
+    
+    // 去掉相同的前缀和后缀，只记录中间变化的区间
+    int prefix = 0;
+    const int common = qMin(before.size(), after.size());
+    while (prefix < common && before.at(prefix) == after.at(prefix)) {
+        ++prefix;
+    }
+    int suffix = 0;
+    while (suffix < common - prefix &&
+           before.at(before.size() - 1 - suffix) == after.at(after.size() - 1 - suffix)) {
+        ++suffix;
+    }
+    
+    const int removed = before.size() - prefix - suffix;
+    QVariantList inserted = after.mid(prefix, after.size() - prefix - suffix);
+    if (removed == 0 && inserted.isEmpty()) {
+        return;
+    }
+    
+    quint16 id = nameId(name);
+    m_stream << quint8(ListDelta);
+    writeTime();
+    m_stream << id << qint32(prefix) << qint32(removed) << inserted;
+    ++m_count;
+}
+
+// ========== 回放 ==========
+
+QuikReplayer::QuikReplayer(QuikContext* context, QObject* parent)
+    : QObject(parent)
+    , m_context(context)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &QuikReplayer::step);
+}
+
+bool QuikReplayer::load(const QString& filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "[Quik] Cannot open recording:" << filePath;
+        return false;
+    }
+    
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    
+    quint32 magic = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    if (magic != QuikRecorder::Magic || version != QuikRecorder::Version) {
+        qWarning() << "[Quik] Not a Quik recording (or unsupported version):" << filePath;
+        return false;
+    }
+    
+    m_events.clear();
+    QHash<quint16, QString> names;
+    qint64 timeUs = 0;
+    
+    while (!stream.atEnd()) {
+        quint8 type = 0;
+        stream >> type;
+        
+        if (type == QuikRecorder::DefineName) {
+            quint16 id;
+            QString name;
+            stream >> id >> name;
+            names.insert(id, name);
+            continue;
+        }
+        
+        quint32 deltaUs = 0;
+        quint16 id = 0;
+        stream >> deltaUs >> id;
+        timeUs += deltaUs;
+        
+        Event event;
+        event.type = QuikRecorder::RecordType(type);
+        event.timeUs = timeUs;
+        event.name = names.value(id);
+        event.offset = 0;
+        event.removed = 0;
+        
+        if (type == QuikRecorder::Value) {
+            stream >> event.value;
+        } else if (type == QuikRecorder::ListDelta) {
+            qint32 offset, removed;
+            stream >> offset >> removed >> event.inserted;
+            event.offset = offset;
+            event.removed = removed;
+        } else {
+            qWarning() << "[Quik] Unknown record type" << type << "in" << filePath;
+            return false;
+        }
+        
+        if (stream.status() != QDataStream::Ok) {
+            qWarning() << "[Quik] Truncated recording:" << filePath;
+            break;
+        }
+        m_events.append(event);
+    }
+    
+    qDebug() << "[Quik] Loaded recording:" << m_events.size() << "events," << durationMs() << "ms";
+    return true;
+}
+
+void QuikReplayer::start(Speed speed) {
+    if (!m_context) return;
+    
+    stop();
+    m_context->resetProfile();
+    m_context->setProfilingEnabled(true);
+    m_next = 0;
+    m_running = true;
+    m_clock.start();
+    
+    if (speed == MaximumSpeed) {
+        while (m_next < m_events.size()) {
+            apply(m_events.at(m_next++));
+        }
+        finish();
+    } else {
+        step();
+    }
+}
+
+void QuikReplayer::stop() {
+    m_timer->stop();
+    m_running = false;
+}
+
+void QuikReplayer::step() {
+    if (!m_running || !m_context) return;
+    
+    const qint64 nowUs = m_clock.nsecsElapsed() / 1000;
+    while (m_next < m_events.size() && m_events.at(m_next).timeUs <= nowUs) {
+        apply(m_events.at(m_next++));
+    }
+    
+    if (m_next >= m_events.size()) {
+        finish();
+        return;
+    }
+    
+    const qint64 waitUs = m_events.at(m_next).timeUs - m_clock.nsecsElapsed() / 1000;
+    m_timer->start(int(qMax<qint64>(0, waitUs / 1000)));
+}
+
+void QuikReplayer::apply(const Event& event) {
+    if (event.type == QuikRecorder::Value) {
+        m_context->setValue(event.name, event.value);
+        return;
+    }
+    
+    QVariantList items = m_context->getListData(event.name);
+    const int offset = qBound(0, event.offset, items.size());
+    const int removed = qBound(0, event.removed, items.size() - offset);
+    items.erase(items.begin() + offset, items.begin() + offset + removed);
+    for (int i = 0; i < event.inserted.size(); ++i) {
+        items.insert(offset + i, event.inserted.at(i));
+    }
+    m_context->setListData(event.name, items);
+}
+
+void QuikReplayer::finish() {
+    m_elapsedMs = m_clock.elapsed();
+    m_running = false;
+    qDebug() << "[Quik] Replay finished:" << m_events.size() << "events in" << m_elapsedMs << "ms";
+    emit finished();
+}
+
+ProfileReport QuikReplayer::profile() const {
+    return m_context ? m_context->profile() : ProfileReport();
+}
+
+} // namespace Quik
@@ -0,0 +1,190 @@
+#ifndef QUIKREPLAY_H
+#define QUIKREPLAY_H
+
+#include "Quik/QuikAPI.h"
+#include "core/QuikContext.h"
+#include <QObject>
+#include <QFile>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
+
+class QTimer;
+
+namespace Quik {
+
+/**
+ * @brief 变量变化流的二进制记录
+ *
+ * 由 QuikContext::startRecording 创建，记录每次实际改变的变量值和 setListData 的差量。
+ * 格式（QDataStream，Qt_5_6）：
+ * - 文件头：quint32 魔数 'QKRC'，quint16 版本
+ * - 名称定义：quint8 0，quint16 名称ID，QString 名称（每个名称只写一次）
+ * - 变量值：quint8 1，quint32 距上一条的微秒数，quint16 名称ID，QVariant 值
+ * - 列表差量：quint8 2，quint32 距上一条的微秒数，quint16 名称ID，
+ *   qint32 起始位置，qint32 删除条数，QVariantList 插入的条目
+ *
+ * 开始记录时先写入当前所有变量和数据源（时间为0），回放从相同的初始状态开始。
+ */
+class QUIK_API QuikRecorder {
+public:
+    static const quint32 Magic = 0x514B5243;   // 'QKRC'
+    static const quint16 Version = 1;
+    
+    enum RecordType : quint8 {
+        DefineName = 0,
+        Value = 1,
+        ListDelta = 2
+    };
+    
+    /**
+     * @brief 创建记录文件并写入文件头
+     * @return 是否成功
+     */
+    bool open(const QString& filePath);
+    
+    /**
+     * @brief 关闭记录文件
+     */
+    void close();
+    
+    bool isOpen() const { return m_file.isOpen(); }
+    
+    /**
+     * @brief 已写入的记录数（不含名称定义）
+     */
+    quint64 recordCount() const { return m_count; }
+    
+    /**
+     * @brief 记录变量值
+     */
+    void recordValue(const QString& name, const QVariant& value);
+    
+    /**
+     * @brief 记录列表变化（只写入变化的区间）
+     * @param before 变化前的列表
+     * @param after 变化后的列表
+     */
+    void recordListData(const QString& name, const QVariantList& before, const QVariantList& after);
+    
+private:
+    quint16 nameId(const QString& name);
+    void writeTime();
+    
+    QFile m_file;
+    QDataStream m_stream;
+    QElapsedTimer m_clock;
+    qint64 m_lastUs = 0;
+    QHash<QString, quint16> m_names;
+    quint64 m_count = 0;
+};
+
+/**
+ * @brief 变量变化流的回放
+ *
+ * 把 QuikRecorder 记录的变化按顺序写回上下文（通常是不显示的 builder 的上下文），
+ * 可按原始节奏或最快速度回放，回放时自动开启性能计数，结束后通过 profile() 获取报告。
+ * 用户现场的操作序列因此可以作为可重复的基准测试。
+ *
+ * 使用示例：
+ * @code
+ * Quik::XMLUIBuilder builder;
+ * builder.buildFromFile("Panel.xml");          // 不显示
+ * Quik::QuikReplayer replayer(builder.context());
+ * if (replayer.load("session.quikrec")) {
+ *     replayer.start(Quik::QuikReplayer::MaximumSpeed);
+ *     qDebug() << replayer.eventCount() << "events in" << replayer.elapsedMs() << "ms";
+ *     ProfileReport report = replayer.profile();
+ *     report.sortBy(ProfileReport::ByTotalTime);
+ *     qDebug().noquote() << report.toString(20);
+ * }
+ * @endcode
+ */
+class QUIK_API QuikReplayer : public QObject {
+    Q_OBJECT
+    
+public:
+    enum Speed {
+        OriginalSpeed,  // 按记录的时间间隔回放（需要事件循环）
+        MaximumSpeed    // 同步回放全部事件
+    };
+    
+    explicit QuikReplayer(QuikContext* context, QObject* parent = nullptr);
+    
+    /**
+     * @brief 读取记录文件
+     * @return 是否成功（文件不存在、魔数或版本不匹配时失败）
+     */
+    bool load(const QString& filePath);
+    
+    /**
+     * @brief 事件数
+     */
+    int eventCount() const { return m_events.size(); }
+    
+    /**
+     * @brief 记录的总时长（毫秒）
+     */
+    qint64 durationMs() const { return m_events.isEmpty() ? 0 : m_events.last().timeUs / 1000; }
+    
+    /**
+     * @brief 开始回放（MaximumSpeed 时返回即已完成）
+     */
+    void start(Speed speed = MaximumSpeed);
+    
+    /**
+     * @brief 停止回放
+     */
+    void stop();
+    
+    bool isRunning() const { return m_running; }
+    
+    /**
+     * @brief 回放耗时（毫秒）
+     */
+    qint64 elapsedMs() const { return m_elapsedMs; }
+    
+    /**
+     * @brief 回放期间收集的性能报告
+     */
+    ProfileReport profile() const;
+    
+signals:
+    /**
+     * @brief 回放完成
+     */
+    void finished();
+    
+private slots:
+    /**
+     * @brief 应用到期的事件并调度下一批（OriginalSpeed）
+     */
+    void step();
+    
+private:
+    struct Event {
+        QuikRecorder::RecordType type;
+        qint64 timeUs;
+        QString name;
+        QVariant value;
+        int offset;
+        int removed;
+        QVariantList inserted;
+    };
+    
+    void apply(const Event& event);
+    void finish();
+    
+    QPointer<QuikContext> m_context;
+    QVector<Event> m_events;
+    QTimer* m_timer;
+    QElapsedTimer m_clock;
+    int m_next = 0;
+    bool m_running = false;
+    qint64 m_elapsedMs = 0;
+};
+
+} // namespace Quik
+
+#endif // QUIKREPLAY_H
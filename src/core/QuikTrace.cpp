@@ -0,0 +1,120 @@
+#include "QuikTrace.h"
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <QThread>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+namespace Quik {
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    QString detail;
+    qint64 start;
+    qint64 duration;
+    quint64 thread;
+};
+
+struct TraceBuffer {
+    QMutex mutex;
+    QVector<TraceEvent> events;
+    QElapsedTimer clock;
+};
+
+TraceBuffer& buffer() {
+    static TraceBuffer instance;
+    return instance;
+}
+
+} // anonymous namespace
+
+std::atomic<bool> QuikTrace::s_enabled(false);
+
+void QuikTrace::start() {
+    TraceBuffer& trace = buffer();
+    {
+        QMutexLocker locker(&trace.mutex);
+        trace.events.clear();
+        trace.clock.start();
+    }
+    s_enabled.store(true, std::memory_order_relaxed);
+    qDebug() << "[Quik] Trace recording started";
+}
+
+void QuikTrace::stop() {
+    s_enabled.store(false, std::memory_order_relaxed);
+    qDebug() << "[Quik] Trace recording stopped," << eventCount() << "events";
+}
+
+int QuikTrace::eventCount() {
+    TraceBuffer& trace = buffer();
+    QMutexLocker locker(&trace.mutex);
+    return trace.events.size();
+}
+
+qint64 QuikTrace::timestamp() {
+    return buffer().clock.nsecsElapsed() / 1000;
+}
+
+void QuikTrace::record(const char* name, const QString& detail, qint64 startUs, qint64 durationUs) {
+    TraceEvent event;
+    event.name = name;
+    event.detail = detail;
+    event.start = startUs;
+    event.duration = durationUs;
+    event.thread = reinterpret_cast<quintptr>(QThread::currentThreadId());
+    
+    TraceBuffer& trace = buffer();
+    QMutexLocker locker(&trace.mutex);
+    trace.events.append(event);
+}
+
+bool QuikTrace::save(const QString& filePath) {
+    QJsonArray events;
+    {
+        TraceBuffer& trace = buffer();
+        QMutexLocker locker(&trace.mutex);
+        const qint64 pid = QCoreApplication::applicationPid();
+        for (const TraceEvent& event : trace.events) {
+            QJsonObject json;
+            json["name"] = QString::fromLatin1(event.name);
+            json["cat"] = "quik";
+            json["ph"] = "X";
+            json["ts"] = double(event.start);
+            json["dur"] = double(event.duration);
+            json["pid"] = double(pid);
+            json["tid"] = double(event.thread);
+            if (!event.detail.isEmpty()) {
+                QJsonObject args;
+                args["detail"] = event.detail;
+                json["args"] = args;
+            }
+            events.append(json);
+        }
+    }
+    
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+    
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[Quik] Cannot write trace file:" << filePath;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.close();
+    
+    qDebug() << "[Quik] Trace saved to" << filePath << "(" << events.size() << "events)";
+    return true;
+}
+
+} // namespace Quik
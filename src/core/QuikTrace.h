@@ -0,0 +1,120 @@
+#ifndef QUIKTRACE_H
+#define QUIKTRACE_H
+
+#include "Quik/QuikAPI.h"
+#include <QString>
+#include <atomic>
+
+namespace Quik {
+
+/**
+ * @brief 构建与传播阶段的 Chrome trace 记录
+ *
+ * 记录的区间（"X" 完整事件）可保存为 Chrome trace-event JSON，用 Perfetto 或 chrome://tracing 打开。
+ * 未开启时每个区间只有一次原子读（relaxed），可以常驻在发布版本中。
+ * 记录线程安全，build/传播之外的线程也可以使用 QUIK_TRACE_SCOPE。
+ *
+ * 使用示例：
+ * @code
+ * Quik::QuikTrace::start();
+ * QWidget* ui = Quik_BUILD(builder, "Panel.xml");
+ * Quik::QuikTrace::stop();
+ * Quik::QuikTrace::save("startup.trace.json");
+ * @endcode
+ */
+class QUIK_API QuikTrace {
+public:
+    /**
+     * @brief 清空已有事件并开始记录
+     */
+    static void start();
+    
+    /**
+     * @brief 停止记录（已记录的事件保留，直到下次 start）
+     */
+    static void stop();
+    
+    /**
+     * @brief 是否正在记录
+     */
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 保存为 Chrome trace-event JSON
+     * @param filePath 文件路径
+     * @return 是否成功
+     */
+    static bool save(const QString& filePath);
+    
+    /**
+     * @brief 已记录的事件数
+     */
+    static int eventCount();
+    
+    /**
+     * @brief 自 start 以来的微秒数
+     */
+    static qint64 timestamp();
+    
+    /**
+     * @brief 记录一个完整区间（通常由 TraceScope 调用）
+     * @param name 区间名（须为静态字符串）
+     * @param detail 附加信息（显示在 args.detail 中），可为空
+     * @param startUs 开始时间（timestamp()）
+     * @param durationUs 持续时间（微秒）
+     */
+    static void record(const char* name, const QString& detail, qint64 startUs, qint64 durationUs);
+    
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+/**
+ * @brief 作用域区间：构造时开始，析构时记录
+ *
+ * 通过 QUIK_TRACE_SCOPE / QUIK_TRACE_SCOPE_DETAIL 使用，未开启记录时不计时也不构造 detail。
+ */
+class QUIK_API TraceScope {
+public:
+    explicit TraceScope(const char* name)
+        : m_name(name)
+        , m_start(QuikTrace::isEnabled() ? QuikTrace::timestamp() : -1) {}
+    
+    ~TraceScope() {
+        if (m_start >= 0) {
+            QuikTrace::record(m_name, m_detail, m_start, QuikTrace::timestamp() - m_start);
+        }
+    }
+    
+    bool isActive() const { return m_start >= 0; }
+    void setDetail(const QString& detail) { m_detail = detail; }
+    
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+    
+private:
+    const char* m_name;
+    qint64 m_start;
+    QString m_detail;
+};
+
+} // namespace Quik
+
+#define QUIK_TRACE_CONCAT_(a, b) a##b
+#define QUIK_TRACE_CONCAT(a, b) QUIK_TRACE_CONCAT_(a, b)
+
+/**
+ * @brief 记录当前作用域为一个区间
+ */
+#define QUIK_TRACE_SCOPE(name) \
+    ::Quik::TraceScope QUIK_TRACE_CONCAT(quikTraceScope_, __LINE__)(name)
+
+/**
+ * @brief 记录当前作用域为一个区间，并附加信息（detail 表达式只在记录开启时求值）
+ */
+#define QUIK_TRACE_SCOPE_DETAIL(name, detail) \
+    QUIK_TRACE_SCOPE(name); \
+    if (QUIK_TRACE_CONCAT(quikTraceScope_, __LINE__).isActive()) \
+        QUIK_TRACE_CONCAT(quikTraceScope_, __LINE__).setDetail(detail)
+
+#endif // QUIKTRACE_H
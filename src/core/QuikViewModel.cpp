@@ -54,6 +54,27 @@ void QuikViewModel::setValue<QString>(const QString& name, const QString& value)
     m_builder->setValue(name, value);
 }
 
+// postValue 特化 - 线程安全投递，转换规则与 setValue 一致
+template<>
+void QuikViewModel::postValue<bool>(const QString& name, const bool& value) {
+    m_builder->postValue(name, value ? 1 : 0);
+}
+
+template<>
+void QuikViewModel::postValue<int>(const QString& name, const int& value) {
+    m_builder->postValue(name, value);
+}
+
+template<>
+void QuikViewModel::postValue<double>(const QString& name, const double& value) {
+    m_builder->postValue(name, QString::number(value));
+}
+
+template<>
+void QuikViewModel::postValue<QString>(const QString& name, const QString& value) {
+    m_builder->postValue(name, value);
+}
+
 // QVector3D 特化 - 用于PointLineEdit
 template<>
 QVector3D QuikViewModel::getValue<QVector3D>(const QString& name) const {
@@ -199,4 +220,16 @@ void QuikViewModel::watchAll(std::function<void(const QString&, const QVariant&)
     QObject::connect(m_builder->context(), &QuikContext::variableChanged, callback);
 }
 
+// 异步计算值
+AsyncComputed* QuikViewModel::computeAsync(const VarBase& output,
+                                           std::initializer_list<std::reference_wrapper<const VarBase>> inputs,
+                                           AsyncComputeFunction compute,
+                                           QThreadPool* pool) {
+    QStringList inputNames;
+    for (const auto& varRef : inputs) {
+        inputNames << varRef.get().name();
+    }
+    return new AsyncComputed(m_builder, output.name(), inputNames, compute, pool);
+}
+
 } // namespace Quik
@@ -2,6 +2,7 @@
 #define QuikViewModel_H
 
 #include "Quik/QuikAPI.h"
+#include "core/AsyncComputed.h"
 #include <QString>
 #include <QVariant>
 #include <QMap>
@@ -31,17 +32,19 @@ public:
  *   double v = maxSize;          // 隐式获取值
  *   maxSize = 0.5;               // 赋值，UI自动更新
  *   maxSize.watch([](double v) { ... });  // 类型安全的监听
+ *   maxSize.postValue(0.5);      // 工作线程中投递，GUI线程批量应用
  */
 template<typename T>
 class Var : public VarBase {
 public:
-    Var() : m_getter(nullptr), m_setter(nullptr), m_watcher(nullptr) {}
+    Var() : m_getter(nullptr), m_setter(nullptr), m_watcher(nullptr), m_poster(nullptr) {}
     
     Var(const QString& name,
         std::function<T()> getter, 
         std::function<void(const T&)> setter,
-        std::function<void(std::function<void(const T&)>)> watcher = nullptr)
-        : m_name(name), m_getter(getter), m_setter(setter), m_watcher(watcher) {}
+        std::function<void(std::function<void(const T&)>)> watcher = nullptr,
+        std::function<void(const T&)> poster = nullptr)
+        : m_name(name), m_getter(getter), m_setter(setter), m_watcher(watcher), m_poster(poster) {}
     
     // 获取变量名
     QString name() const override { return m_name; }
@@ -92,6 +95,13 @@ public:
         }
     }
     
+    // 从任意线程投递值（线程安全，同一变量合并为最后一次写入）
+    void postValue(const T& val) {
+        if (m_poster) {
+            m_poster(val);
+        }
+    }
+    
     // 监听变化 - 类型安全，无需硬编码变量名
     void watch(std::function<void(const T&)> callback) {
         if (m_watcher) {
@@ -104,6 +114,7 @@ private:
     std::function<T()> m_getter;
     std::function<void(const T&)> m_setter;
     std::function<void(std::function<void(const T&)>)> m_watcher;
+    std::function<void(const T&)> m_poster;
 };
 
 /**
@@ -283,7 +294,8 @@ public:
             [this, name](const T& v) { setValue<T>(name, v); },
             [this, name](std::function<void(const T&)> callback) {
                 watchVar<T>(name, callback);
-            }
+            },
+            [this, name](const T& v) { postValue<T>(name, v); }
         );
     }
     
@@ -343,6 +355,36 @@ public:
      */
     void watchAll(std::function<void(const QString&, const QVariant&)> callback);
     
+    /**
+     * @brief 声明异步计算值：输入变化时在线程池中计算输出
+     * @param output 输出变量
+     * @param inputs 输入变量列表
+     * @param compute 计算函数（在工作线程执行，只能访问 inputs 快照）
+     * @param pool 线程池，默认 QThreadPool::globalInstance()
+     * @return 计算对象（归 builder 所有）
+     * 
+     * 新的输入变化会取消正在运行的任务，且只有最新输入的结果会写回输出变量，
+     * 拖动滑块时不会堆积过期计算。
+     * 
+     * 使用示例：
+     * @code
+     * auto maxSize = vm.var<double>("mesh.maxSize");
+     * auto stats = vm.var<QString>("mesh.stats");
+     * vm.computeAsync(stats, {maxSize}, [](const QVariantMap& in, const Quik::CancelToken& token) -> QVariant {
+     *     MeshStats s;
+     *     for (int i = 0; i < cellCount; ++i) {
+     *         if (token.isCancelled()) return QVariant();  // 已被新输入取代
+     *         s.accumulate(i, in["mesh.maxSize"].toDouble());
+     *     }
+     *     return s.summary();
+     * });
+     * @endcode
+     */
+    AsyncComputed* computeAsync(const VarBase& output,
+                                std::initializer_list<std::reference_wrapper<const VarBase>> inputs,
+                                AsyncComputeFunction compute,
+                                QThreadPool* pool = nullptr);
+    
     // 获取原始builder
     XMLUIBuilder* builder() const { return m_builder; }
 
@@ -353,6 +395,9 @@ private:
     template<typename T>
     void setValue(const QString& name, const T& value);
     
+    template<typename T>
+    void postValue(const QString& name, const T& value);
+    
     template<typename T>
     void watchVar(const QString& name, std::function<void(const T&)> callback);
     
@@ -370,6 +415,11 @@ template<> QUIK_API void QuikViewModel::setValue<int>(const QString& name, const
 template<> QUIK_API void QuikViewModel::setValue<double>(const QString& name, const double& value);
 template<> QUIK_API void QuikViewModel::setValue<QString>(const QString& name, const QString& value);
 
+template<> QUIK_API void QuikViewModel::postValue<bool>(const QString& name, const bool& value);
+template<> QUIK_API void QuikViewModel::postValue<int>(const QString& name, const int& value);
+template<> QUIK_API void QuikViewModel::postValue<double>(const QString& name, const double& value);
+template<> QUIK_API void QuikViewModel::postValue<QString>(const QString& name, const QString& value);
+
 template<> QUIK_API void QuikViewModel::watchVar<bool>(const QString& name, std::function<void(const bool&)> callback);
 template<> QUIK_API void QuikViewModel::watchVar<int>(const QString& name, std::function<void(const int&)> callback);
 template<> QUIK_API void QuikViewModel::watchVar<double>(const QString& name, std::function<void(const double&)> callback);
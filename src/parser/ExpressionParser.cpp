@@ -1,9 +1,577 @@
 #include "ExpressionParser.h"
-#include <QRegularExpression>
+#include "Lexer.h"
 #include <QDebug>
+#include <algorithm>
+#include <cmath>
 
 namespace Quik {
 
+namespace {
+
+/**
+ * @brief 算术表达式递归下降求值器
+ * 
+ * expr    := term (('+' | '-') term)*
+ * term    := unary (('*' | '/' | '%') unary)*
+ * unary   := ('-' | '+') unary | primary
+ * primary := number | '$' name | '(' expr ')'
+ */
+class ArithmeticEvaluator {
+public:
+    ArithmeticEvaluator(const QString& expr, const QVariantMap& context)
+        : m_expr(expr), m_context(context) {}
+    
+    QVariant evaluate() {
+        double result = parseExpr();
+        skipSpaces();
+        if (m_ok && m_pos < m_expr.size()) {
+            fail(QString("Unexpected '%1' at %2").arg(m_expr.at(m_pos)).arg(m_pos));
+        }
+        if (!m_ok || !std::isfinite(result)) {
+            return QVariant();
+        }
+        return result;
+    }
+    
+private:
+    double parseExpr() {
+        double left = parseTerm();
+        while (m_ok) {
+            skipSpaces();
+            if (match('+')) {
+                left += parseTerm();
+            } else if (match('-')) {
+                left -= parseTerm();
+            } else {
+                break;
+            }
+        }
+        return left;
+    }
+    
+    double parseTerm() {
+        double left = parseUnary();
+        while (m_ok) {
+            skipSpaces();
+            if (match('*')) {
+                left *= parseUnary();
+            } else if (match('/')) {
+                left /= parseUnary();
+            } else if (match('%')) {
+                left = std::fmod(left, parseUnary());
+            } else {
+                break;
+            }
+        }
+        return left;
+    }
+    
+    double parseUnary() {
+        skipSpaces();
+        if (match('-')) return -parseUnary();
+        if (match('+')) return parseUnary();
+        return parsePrimary();
+    }
+    
+    double parsePrimary() {
+        skipSpaces();
+        if (m_pos >= m_expr.size()) {
+            fail("Unexpected end of expression");
+            return 0.0;
+        }
+        
+        // 括号
+        if (match('(')) {
+            double value = parseExpr();
+            skipSpaces();
+            if (!match(')')) {
+                fail("Missing ')'");
+            }
+            return value;
+        }
+        
+        // 变量 $name（支持点号，如 $mesh.maxSize）
+        if (match('$')) {
+            int start = m_pos;
+            while (m_pos < m_expr.size() && isNameChar(m_expr.at(m_pos))) {
+                ++m_pos;
+            }
+            QString name = m_expr.mid(start, m_pos - start);
+            QVariant value = m_context.value(name);
+            if (!value.isValid()) {
+                fail(QString("Variable not found: %1").arg(name));
+                return 0.0;
+            }
+            bool ok = false;
+            double number = value.toDouble(&ok);
+            if (!ok) {
+                fail(QString("Variable is not a number: %1").arg(name));
+                return 0.0;
+            }
+            return number;
+        }
+        
+        // 数值字面量
+        int start = m_pos;
+        while (m_pos < m_expr.size() && (m_expr.at(m_pos).isDigit() || m_expr.at(m_pos) == '.')) {
+            ++m_pos;
+        }
+        // 指数部分，如 1e-3
+        if (m_pos > start && m_pos < m_expr.size() && (m_expr.at(m_pos) == 'e' || m_expr.at(m_pos) == 'E')) {
+            int save = m_pos++;
+            if (m_pos < m_expr.size() && (m_expr.at(m_pos) == '+' || m_expr.at(m_pos) == '-')) ++m_pos;
+            if (m_pos < m_expr.size() && m_expr.at(m_pos).isDigit()) {
+                while (m_pos < m_expr.size() && m_expr.at(m_pos).isDigit()) ++m_pos;
+            } else {
+                m_pos = save;
+            }
+        }
+        bool ok = false;
+        double number = m_expr.mid(start, m_pos - start).toDouble(&ok);
+        if (!ok) {
+            fail(QString("Unexpected '%1' at %2").arg(m_expr.at(start)).arg(start));
+            return 0.0;
+        }
+        return number;
+    }
+    
+    static bool isNameChar(QChar c) {
+        return c.isLetterOrNumber() || c == '_' || c == '.';
+    }
+    
+    void skipSpaces() {
+        while (m_pos < m_expr.size() && m_expr.at(m_pos).isSpace()) ++m_pos;
+    }
+    
+    bool match(QChar c) {
+        if (m_pos < m_expr.size() && m_expr.at(m_pos) == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+    
+    void fail(const QString& message) {
+        if (m_ok) {
+            qWarning() << "[Quik] Arithmetic error in" << m_expr << ":" << message;
+        }
+        m_ok = false;
+    }
+    
+    const QString& m_expr;
+    const QVariantMap& m_context;
+    int m_pos = 0;
+    bool m_ok = true;
+};
+
+CompareOp compareOpFromString(const QString& op) {
+    if (op == QLatin1String("==")) return CompareOp::Equal;
+    if (op == QLatin1String("!=")) return CompareOp::NotEqual;
+    if (op == QLatin1String(">"))  return CompareOp::Greater;
+    if (op == QLatin1String("<"))  return CompareOp::Less;
+    if (op == QLatin1String(">=")) return CompareOp::GreaterEqual;
+    if (op == QLatin1String("<=")) return CompareOp::LessEqual;
+    if (op == QLatin1String("in")) return CompareOp::In;
+    if (op == QLatin1String("not in")) return CompareOp::NotIn;
+    return CompareOp::Invalid;
+}
+
+// 通用比较（整数、字符串）
+template<typename T>
+bool applyCompare(CompareOp op, const T& left, const T& right) {
+    switch (op) {
+    case CompareOp::Equal:        return left == right;
+    case CompareOp::NotEqual:     return !(left == right);
+    case CompareOp::Greater:      return right < left;
+    case CompareOp::Less:         return left < right;
+    case CompareOp::GreaterEqual: return !(left < right);
+    case CompareOp::LessEqual:    return !(right < left);
+    case CompareOp::In:
+    case CompareOp::NotIn:
+    case CompareOp::Invalid:      break;
+    }
+    return false;
+}
+
+// 浮点比较：相等判断处理精度问题
+template<>
+bool applyCompare<double>(CompareOp op, const double& left, const double& right) {
+    switch (op) {
+    case CompareOp::Equal:
+        if (left == 0.0 && right == 0.0) return true;
+        return qFuzzyCompare(left, right);
+    case CompareOp::NotEqual:
+        if (left == 0.0 && right == 0.0) return false;
+        return !qFuzzyCompare(left, right);
+    case CompareOp::Greater:      return left > right;
+    case CompareOp::Less:         return left < right;
+    case CompareOp::GreaterEqual: return left >= right;
+    case CompareOp::LessEqual:    return left <= right;
+    case CompareOp::In:
+    case CompareOp::NotIn:
+    case CompareOp::Invalid:      break;
+    }
+    return false;
+}
+
+// 按 QVariant 的实际类型取数值，数值类型不经过字符串转换
+bool toNumber(const QVariant& value, double& out) {
+    switch (value.type()) {
+    case QVariant::Int:       out = value.toInt(); return true;
+    case QVariant::Double:    out = value.toDouble(); return true;
+    case QVariant::Bool:      out = value.toBool() ? 1.0 : 0.0; return true;
+    case QVariant::LongLong:  out = double(value.toLongLong()); return true;
+    case QVariant::UInt:      out = value.toUInt(); return true;
+    case QVariant::ULongLong: out = double(value.toULongLong()); return true;
+    default: {
+        bool ok = false;
+        out = value.toDouble(&ok);
+        return ok;
+    }
+    }
+}
+
+bool isIntegerType(const QVariant& value) {
+    switch (value.type()) {
+    case QVariant::Int:
+    case QVariant::Bool:
+    case QVariant::LongLong:
+    case QVariant::UInt:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// QString::append(QStringView) 在 Qt 6 才有，这里用指针和长度兼容 Qt 5.15
+void appendView(QString& out, QStringView view) {
+    out.append(view.data(), int(view.size()));
+}
+
+} // anonymous namespace
+
+/**
+ * @brief 条件表达式的优先级递归下降解析器（基于 Lexer 的词法单元）
+ * 
+ * or      := and (('or' | '||') and)*
+ * and     := unary (('and' | '&&') unary)*
+ * unary   := ('not' | '!') unary | primary
+ * primary := '(' or ')' | compare
+ * compare := operand ('==' | '!=' | '>=' | '<=' | '>' | '<') operand
+ *          | operand ('in' | 'not' 'in') '[' [literal (',' literal)*] ']'
+ * 
+ * 左侧操作数是 $变量（兼容省略 $），右侧是 $变量、数值、引号字符串或裸字符串。
+ * 裸字符串可以包含空格，到逻辑运算符或右括号为止，与原来的 "$mode==Some Value" 写法兼容。
+ */
+class CompiledExpression::Parser {
+public:
+    Parser(const QString& expr, CompiledExpression& out)
+        : m_expr(expr), m_tokens(Lexer::tokenize(expr)), m_out(out) {}
+    
+    bool parse() {
+        int root = parseOr();
+        if (m_ok && current().type != Token::End) {
+            unexpected();
+        }
+        if (!m_ok) {
+            return false;
+        }
+        m_out.m_root = root;
+        return true;
+    }
+    
+private:
+    int parseOr() {
+        QVector<int> operands;
+        operands.append(parseAnd());
+        while (m_ok && (isKeyword("or") || isOperator("||"))) {
+            ++m_index;
+            operands.append(parseAnd());
+        }
+        return makeGroup(NodeKind::Or, operands);
+    }
+    
+    int parseAnd() {
+        QVector<int> operands;
+        operands.append(parseUnary());
+        while (m_ok && (isKeyword("and") || isOperator("&&"))) {
+            ++m_index;
+            operands.append(parseUnary());
+        }
+        return makeGroup(NodeKind::And, operands);
+    }
+    
+    int parseUnary() {
+        if (isKeyword("not") || isOperator("!")) {
+            ++m_index;
+            return makeGroup(NodeKind::Not, QVector<int>() << parseUnary(), true);
+        }
+        return parsePrimary();
+    }
+    
+    int parsePrimary() {
+        if (current().type == Token::LParen) {
+            ++m_index;
+            int inner = parseOr();
+            if (m_ok) {
+                if (current().type == Token::RParen) {
+                    ++m_index;
+                } else {
+                    fail("Missing ')'");
+                }
+            }
+            return inner;
+        }
+        
+        return parseCompare();
+    }
+    
+    int parseCompare() {
+        Condition cond;
+        
+        // 左侧变量（兼容省略$）
+        const Token& left = current();
+        if (left.type == Token::Variable || Lexer::isName(m_expr, left)) {
+            cond.variable = Lexer::text(m_expr, left).toString();
+        }
+        if (cond.variable.isEmpty()) {
+            unexpected("Expected variable");
+            return -1;
+        }
+        ++m_index;
+        
+        // 集合运算：in [...] / not in [...]
+        if (isKeyword("in") || (isKeyword("not") && Lexer::isKeyword(m_expr, peek(1), QLatin1String("in")))) {
+            cond.op = isKeyword("in") ? QString("in") : QString("not in");
+            m_index += cond.op == "in" ? 1 : 2;
+            if (!parseSetLiteral(cond)) return -1;
+            return appendCompare(cond);
+        }
+        
+        // 比较运算符
+        const Token& op = current();
+        if (op.type == Token::Operator && !isOperator("!") && !isOperator("&&") && !isOperator("||")) {
+            cond.op = Lexer::text(m_expr, op).toString();
+            ++m_index;
+        } else {
+            fail(QString("Expected comparison operator after %1").arg(cond.variable));
+            return -1;
+        }
+        
+        // 右侧：变量、引号字符串或裸字面量
+        const Token& right = current();
+        if (right.type == Token::Variable) {
+            cond.isRightVariable = true;
+            cond.compareVariable = Lexer::text(m_expr, right).toString();
+            if (cond.compareVariable.isEmpty()) {
+                unexpected("Expected variable");
+                return -1;
+            }
+            ++m_index;
+        } else if (right.type == Token::String) {
+            cond.compareValue = Lexer::text(m_expr, right).toString();
+            ++m_index;
+        } else {
+            QString literal = readBareLiteral();
+            if (!m_ok) return -1;
+            bool ok;
+            double numValue = literal.toDouble(&ok);
+            if (ok) {
+                cond.compareValue = numValue;
+            } else {
+                cond.compareValue = literal;
+            }
+        }
+        
+        return appendCompare(cond);
+    }
+    
+    // 集合常量：[a, b, "c d"]，元素可以是数值、引号字符串或裸字符串
+    bool parseSetLiteral(Condition& cond) {
+        if (current().type != Token::LBracket) {
+            unexpected("Expected '['");
+            return false;
+        }
+        ++m_index;
+        
+        QVariantList values;
+        if (current().type == Token::RBracket) {
+            ++m_index;
+        } else {
+            while (true) {
+                if (current().type == Token::String) {
+                    values.append(Lexer::text(m_expr, current()).toString());
+                    ++m_index;
+                } else {
+                    int first = m_index;
+                    while (current().type != Token::Comma && current().type != Token::RBracket &&
+                           current().type != Token::End && current().type != Token::Error) {
+                        ++m_index;
+                    }
+                    if (m_index == first) {
+                        unexpected("Expected value");
+                        return false;
+                    }
+                    int begin = m_tokens[first].position;
+                    QString literal = m_expr.mid(begin, m_tokens[m_index - 1].end - begin);
+                    bool ok;
+                    double numValue = literal.toDouble(&ok);
+                    values.append(ok ? QVariant(numValue) : QVariant(literal));
+                }
+                
+                if (current().type == Token::Comma) {
+                    ++m_index;
+                } else if (current().type == Token::RBracket) {
+                    ++m_index;
+                    break;
+                } else {
+                    unexpected("Expected ',' or ']'");
+                    return false;
+                }
+            }
+        }
+        
+        cond.compareValue = values;
+        return true;
+    }
+    
+    int appendCompare(Condition& cond) {
+        cond.isValid = true;
+        ExpressionParser::classify(cond);
+        
+        Node node;
+        node.kind = NodeKind::Compare;
+        node.leaf = m_out.m_leaves.size();
+        m_out.m_leaves.append(cond);
+        m_out.m_nodes.append(node);
+        return m_out.m_nodes.size() - 1;
+    }
+    
+    // 裸字面量：连续的词法单元，到逻辑运算符、右括号或结尾为止，取源字符串中的原始片段
+    QString readBareLiteral() {
+        int first = m_index;
+        while (true) {
+            const Token& token = current();
+            if (token.type == Token::End || token.type == Token::RParen ||
+                isOperator("&&") || isOperator("||") || isKeyword("and") || isKeyword("or")) {
+                break;
+            }
+            if (token.type == Token::Error) {
+                unexpected();
+                return QString();
+            }
+            ++m_index;
+        }
+        if (m_index == first) {
+            return QString();
+        }
+        int begin = m_tokens[first].position;
+        return m_expr.mid(begin, m_tokens[m_index - 1].end - begin);
+    }
+    
+    int makeGroup(NodeKind kind, const QVector<int>& operands, bool keepSingle = false) {
+        if (!m_ok) return -1;
+        if (operands.size() == 1 && !keepSingle) return operands.first();
+        
+        Node node;
+        node.kind = kind;
+        node.first = m_out.m_children.size();
+        node.count = operands.size();
+        m_out.m_children += operands;
+        m_out.m_nodes.append(node);
+        return m_out.m_nodes.size() - 1;
+    }
+    
+    const Token& current() const {
+        return peek(0);
+    }
+    
+    const Token& peek(int offset) const {
+        return m_tokens[qMin(m_index + offset, m_tokens.size() - 1)];
+    }
+    
+    bool isKeyword(const char* keyword) const {
+        return Lexer::isKeyword(m_expr, current(), QLatin1String(keyword));
+    }
+    
+    bool isOperator(const char* op) const {
+        return Lexer::isOperator(m_expr, current(), QLatin1String(op));
+    }
+    
+    void unexpected(const QString& message = QString()) {
+        const Token& token = current();
+        QString found = token.type == Token::End
+            ? QString("end of expression")
+            : QString("'%1'").arg(m_expr.mid(token.position, token.end - token.position));
+        fail(QString("%1 at %2, found %3")
+                 .arg(message.isEmpty() ? QString("Unexpected token") : message)
+                 .arg(token.position).arg(found));
+    }
+    
+    void fail(const QString& message) {
+        if (m_ok) {
+            qWarning() << "[Quik] Expression error in" << m_expr << ":" << message;
+        }
+        m_ok = false;
+    }
+    
+    const QString& m_expr;
+    QVector<Token> m_tokens;
+    CompiledExpression& m_out;
+    int m_index = 0;
+    bool m_ok = true;
+};
+
+QStringList CompiledExpression::variables() const {
+    QStringList vars;
+    for (const Condition& cond : m_leaves) {
+        if (!vars.contains(cond.variable)) vars.append(cond.variable);
+        if (cond.isRightVariable && !vars.contains(cond.compareVariable)) vars.append(cond.compareVariable);
+    }
+    return vars;
+}
+
+QString CompiledExpression::toString() const {
+    return isValid() ? nodeToString(m_root) : QString();
+}
+
+QString CompiledExpression::nodeToString(int index) const {
+    const Node& node = m_nodes[index];
+    switch (node.kind) {
+    case NodeKind::Compare:
+        return ExpressionParser::toString(m_leaves[node.leaf]);
+    case NodeKind::Not: {
+        const Node& child = m_nodes[m_children[node.first]];
+        QString inner = nodeToString(m_children[node.first]);
+        return child.kind == NodeKind::Or || child.kind == NodeKind::And
+            ? "not (" + inner + ")" : "not " + inner;
+    }
+    case NodeKind::Or:
+    case NodeKind::And: {
+        QStringList parts;
+        for (int i = 0; i < node.count; ++i) {
+            int childIndex = m_children[node.first + i];
+            QString part = nodeToString(childIndex);
+            // and 内部的 or 需要括号；同类嵌套也保留括号以维持原结构
+            NodeKind childKind = m_nodes[childIndex].kind;
+            if (childKind == NodeKind::Or || childKind == node.kind) {
+                part = "(" + part + ")";
+            }
+            parts.append(part);
+        }
+        return parts.join(node.kind == NodeKind::Or ? " or " : " and ");
+    }
+    }
+    return QString();
+}
+
+bool CompiledExpression::evaluate(const QVariantMap& context) const {
+    return evaluate([&context](int, const Condition& cond) {
+        return ExpressionParser::evaluate(cond, context);
+    });
+}
+
+
 Condition ExpressionParser::parse(const QString& expr) {
     Condition cond;
     
@@ -13,6 +581,12 @@ Condition ExpressionParser::parse(const QString& expr) {
     
     QString cleanExpr = expr.trimmed();
     
+    // 集合运算 $x in [...] / $x not in [...] 由编译器解析
+    if (cleanExpr.contains(" in ", Qt::CaseInsensitive) && cleanExpr.contains('[')) {
+        CompiledExpression compiled = compile(cleanExpr);
+        return compiled.isSingleCondition() ? compiled.leaves().first() : cond;
+    }
+    
     // 移除左侧$前缀
     if (cleanExpr.startsWith("$")) {
         cleanExpr = cleanExpr.mid(1);
@@ -45,6 +619,7 @@ Condition ExpressionParser::parse(const QString& expr) {
             }
             
             cond.isValid = true;
+            classify(cond);
             break;
         }
     }
@@ -66,87 +641,174 @@ bool ExpressionParser::evaluate(const Condition& condition, const QVariantMap& c
         return false;
     }
     
-    // 获取右侧值（可能是固定值，也可能是变量）
-    QVariant rightValue;
-    if (condition.isRightVariable) {
-        // 右侧是变量，从上下文获取
-        rightValue = context.value(condition.compareVariable);
-        if (!rightValue.isValid()) {
-            qWarning() << "[Quik] Variable not found:" << condition.compareVariable;
-            return false;
-        }
-    } else {
-        // 右侧是固定值
-        rightValue = condition.compareValue;
+    // 右侧是固定值：按解析时确定的类型直接比较
+    if (!condition.isRightVariable) {
+        return compareLiteral(leftValue, condition);
     }
     
-    return compareValues(leftValue, condition.op, rightValue);
+    // 右侧是变量，从上下文获取
+    QVariant rightValue = context.value(condition.compareVariable);
+    if (!rightValue.isValid()) {
+        qWarning() << "[Quik] Variable not found:" << condition.compareVariable;
+        return false;
+    }
+    
+    CompareOp op = condition.compareOp != CompareOp::Invalid ? condition.compareOp
+                                                             : compareOpFromString(condition.op);
+    return compareValues(leftValue, op, rightValue);
 }
 
-bool ExpressionParser::evaluate(const QString& expr, const QVariantMap& context) {
-    QString cleanExpr = expr.trimmed();
+void ExpressionParser::classify(Condition& condition) {
+    condition.compareOp = compareOpFromString(condition.op);
+    condition.literalType = LiteralType::None;
+    if (condition.isRightVariable) {
+        return;
+    }
     
-    // 支持括号表达式：递归处理括号
-    if (cleanExpr.contains('(')) {
-        return evaluateWithParentheses(cleanExpr, context);
+    // 集合：字符串放入哈希集合，数值排序去重后供二分查找
+    if (condition.compareOp == CompareOp::In || condition.compareOp == CompareOp::NotIn) {
+        condition.literalType = LiteralType::Set;
+        condition.numberSet.clear();
+        condition.stringSet.clear();
+        for (const QVariant& value : condition.compareValue.toList()) {
+            QString text = value.toString();
+            bool ok = false;
+            double number = text.toDouble(&ok);
+            if (ok) {
+                condition.numberSet.append(number);
+            } else {
+                condition.stringSet.insert(text);
+            }
+        }
+        std::sort(condition.numberSet.begin(), condition.numberSet.end());
+        condition.numberSet.erase(std::unique(condition.numberSet.begin(), condition.numberSet.end()),
+                                  condition.numberSet.end());
+        return;
     }
     
-    // 检查是否包含 and/or 逻辑运算符
-    if (cleanExpr.contains(" and ", Qt::CaseInsensitive) || 
-        cleanExpr.contains(" or ", Qt::CaseInsensitive)) {
-        CompoundCondition compound = parseCompound(expr);
-        return evaluate(compound, context);
+    // 与 compareValues 的规则一致：能转换为数值的常量（含引号中的数字）按数值比较
+    condition.literalText = condition.compareValue.toString();
+    bool ok = false;
+    double number = condition.literalText.toDouble(&ok);
+    if (!ok) {
+        condition.literalType = LiteralType::String;
+        return;
     }
     
-    Condition cond = parse(expr);
-    return evaluate(cond, context);
+    condition.literalDouble = number;
+    qint64 integer = condition.literalText.toLongLong(&ok);
+    if (ok) {
+        condition.literalType = LiteralType::Integer;
+        condition.literalInt = integer;
+    } else {
+        condition.literalType = LiteralType::Double;
+    }
 }
 
-bool ExpressionParser::evaluateWithParentheses(const QString& expr, const QVariantMap& context) {
-    QString result = expr;
+bool ExpressionParser::containsNumber(const Condition& condition, double value) {
+    const QVector<double>& numbers = condition.numberSet;
+    if (value != value) {
+        return false;
+    }
+    if (std::isinf(value)) {
+        return std::binary_search(numbers.constBegin(), numbers.constEnd(), value);
+    }
     
-    // 循环处理最内层括号
-    while (result.contains('(')) {
-        // 找到最内层的括号
-        int closePos = result.indexOf(')');
-        if (closePos < 0) {
-            qWarning() << "[Quik] Mismatched parentheses in expression:" << expr;
-            return false;
+    // 与 value 模糊相等的常量 c 满足 |value - c| <= min(|value|, |c|) / 1e12 <= |value| / 1e12，
+    // 只需检查该窗口内的常量（窗口放宽一倍抵消舍入），如 0.1+0.2 in [0.3]
+    const double tolerance = std::abs(value) * 2e-12;
+    for (auto it = std::lower_bound(numbers.constBegin(), numbers.constEnd(), value - tolerance);
+         it != numbers.constEnd() && *it <= value + tolerance; ++it) {
+        if (applyCompare<double>(CompareOp::Equal, value, *it)) {
+            return true;
         }
-        
-        int openPos = result.lastIndexOf('(', closePos);
-        if (openPos < 0) {
-            qWarning() << "[Quik] Mismatched parentheses in expression:" << expr;
-            return false;
+    }
+    return false;
+}
+
+bool ExpressionParser::compareLiteral(const QVariant& left, const Condition& condition) {
+    switch (condition.literalType) {
+    case LiteralType::Integer:
+        // 整数变量与整数常量：直接整数比较
+        if (isIntegerType(left)) {
+            return applyCompare<qint64>(condition.compareOp, left.toLongLong(), condition.literalInt);
         }
-        
-        // 提取括号内的子表达式
-        QString subExpr = result.mid(openPos + 1, closePos - openPos - 1);
-        
-        // 递归求值子表达式
-        bool subResult = evaluate(subExpr, context);
-        
-        // 用结果替换括号表达式
-        result = result.left(openPos) + (subResult ? "1" : "0") + result.mid(closePos + 1);
+        // fall through
+    case LiteralType::Double: {
+        double number;
+        if (toNumber(left, number)) {
+            return applyCompare<double>(condition.compareOp, number, condition.literalDouble);
+        }
+        return applyCompare<QString>(condition.compareOp, left.toString(), condition.literalText);
+    }
+    case LiteralType::String:
+        return applyCompare<QString>(condition.compareOp, left.toString(), condition.literalText);
+    case LiteralType::Set: {
+        // 数值左值查数值集合，否则（或未命中时）按字符串查
+        bool found = false;
+        double number;
+        if (!condition.numberSet.isEmpty() && toNumber(left, number)) {
+            found = containsNumber(condition, number);
+        }
+        if (!found && !condition.stringSet.isEmpty()) {
+            found = condition.stringSet.contains(left.toString());
+        }
+        return condition.compareOp == CompareOp::In ? found : !found;
+    }
+    case LiteralType::None:
+        break;
     }
     
-    // 处理剩余的表达式
-    return evaluate(result, context);
+    // 手工构造、未分类的条件
+    CompareOp op = condition.compareOp != CompareOp::Invalid ? condition.compareOp
+                                                             : compareOpFromString(condition.op);
+    return compareValues(left, op, condition.compareValue);
+}
+
+bool ExpressionParser::evaluate(const QString& expr, const QVariantMap& context) {
+    // 编译为表达式树后短路求值（支持括号和 and/or/not 优先级）
+    return compile(expr).evaluate(context);
+}
+
+CompiledExpression ExpressionParser::compile(const QString& expr) {
+    CompiledExpression compiled;
+    compiled.m_source = expr.trimmed();
+    if (compiled.m_source.isEmpty()) {
+        return compiled;
+    }
+    
+    CompiledExpression::Parser parser(compiled.m_source, compiled);
+    if (!parser.parse()) {
+        compiled.m_root = -1;
+    }
+    return compiled;
 }
 
 CompoundCondition ExpressionParser::parseCompound(const QString& expr) {
     CompoundCondition compound;
     QString cleanExpr = expr.trimmed();
     
-    // 使用正则表达式分割 and/or
-    QRegularExpression re("\\s+(and|or)\\s+", QRegularExpression::CaseInsensitiveOption);
-    QStringList parts = cleanExpr.split(re);
-    
-    // 提取逻辑运算符
-    QRegularExpressionMatchIterator it = re.globalMatch(cleanExpr);
-    while (it.hasNext()) {
-        QRegularExpressionMatch match = it.next();
-        compound.logicOps.append(match.captured(1).toLower());
+    // 按 and/or（及 &&/||）分割，每段为一个条件
+    QVector<Token> tokens = Lexer::tokenize(cleanExpr);
+    QStringList parts;
+    int partStart = 0;
+    for (const Token& token : tokens) {
+        QString logicOp;
+        if (Lexer::isKeyword(cleanExpr, token, QLatin1String("and")) || 
+            Lexer::isOperator(cleanExpr, token, QLatin1String("&&"))) {
+            logicOp = "and";
+        } else if (Lexer::isKeyword(cleanExpr, token, QLatin1String("or")) || 
+                   Lexer::isOperator(cleanExpr, token, QLatin1String("||"))) {
+            logicOp = "or";
+        } else if (token.type != Token::End) {
+            continue;
+        }
+        
+        parts.append(cleanExpr.mid(partStart, token.position - partStart));
+        partStart = token.end;
+        if (!logicOp.isEmpty()) {
+            compound.logicOps.append(logicOp);
+        }
     }
     
     // 解析每个条件
@@ -168,42 +830,37 @@ bool ExpressionParser::evaluate(const CompoundCondition& compound, const QVarian
         return false;
     }
     
-    // 如果只有一个条件，直接求值
-    if (compound.conditions.size() == 1) {
-        return evaluate(compound.conditions.first(), context);
-    }
-    
-    // 求值第一个条件
-    bool result = evaluate(compound.conditions.first(), context);
-    
-    // 依次应用逻辑运算符
+    // and 优先于 or：按 or 分组，组内遇到 false 即跳过剩余条件，任一组为真即返回
+    bool groupResult = evaluate(compound.conditions.first(), context);
     for (int i = 0; i < compound.logicOps.size() && i + 1 < compound.conditions.size(); ++i) {
-        bool nextResult = evaluate(compound.conditions[i + 1], context);
-        
-        if (compound.logicOps[i] == "and") {
-            result = result && nextResult;
-        } else if (compound.logicOps[i] == "or") {
-            result = result || nextResult;
+        if (compound.logicOps[i] == "or") {
+            if (groupResult) return true;
+            groupResult = evaluate(compound.conditions[i + 1], context);
+        } else if (groupResult) {
+            groupResult = evaluate(compound.conditions[i + 1], context);
         }
     }
     
-    return result;
+    return groupResult;
+}
+
+QVariant ExpressionParser::evaluateArithmetic(const QString& expr, const QVariantMap& context) {
+    return ArithmeticEvaluator(expr, context).evaluate();
 }
 
 bool ExpressionParser::isExpression(const QString& str) {
-    return str.trimmed().startsWith("$");
+    QString trimmed = str.trimmed();
+    return trimmed.startsWith("$") || trimmed.startsWith("(") || trimmed.startsWith("!") ||
+           trimmed.startsWith("not ", Qt::CaseInsensitive);
 }
 
 QStringList ExpressionParser::extractVariables(const QString& expr) {
     QStringList vars;
     
-    // 使用正则表达式提取所有 $varName 形式的变量
-    QRegularExpression re("\\$([a-zA-Z_][a-zA-Z0-9_]*)");
-    QRegularExpressionMatchIterator it = re.globalMatch(expr);
-    
-    while (it.hasNext()) {
-        QRegularExpressionMatch match = it.next();
-        QString varName = match.captured(1);
+    // 提取所有 $varName 形式的变量（支持点号，如 $mesh.maxSize）
+    for (const Token& token : Lexer::tokenize(expr)) {
+        if (token.type != Token::Variable || token.length == 0) continue;
+        QString varName = Lexer::text(expr, token).toString();
         if (!vars.contains(varName)) {
             vars.append(varName);
         }
@@ -212,41 +869,208 @@ QStringList ExpressionParser::extractVariables(const QString& expr) {
     return vars;
 }
 
-bool ExpressionParser::compareValues(const QVariant& left, const QString& op, const QVariant& right) {
-    // 优先尝试数值比较（支持 >, <, >=, <= 等运算符）
-    bool leftOk, rightOk;
-    double leftNum = left.toDouble(&leftOk);
-    double rightNum = right.toDouble(&rightOk);
+QForExpression ExpressionParser::parseQFor(const QString& expr) {
+    QForExpression result;
+    QVector<Token> tokens = Lexer::tokenize(expr);
+    
+    auto isName = [&](int i) { return i < tokens.size() && Lexer::isName(expr, tokens[i]); };
+    auto isType = [&](int i, Token::Type type) { return i < tokens.size() && tokens[i].type == type; };
+    auto isIn = [&](int i) { return i < tokens.size() && Lexer::isKeyword(expr, tokens[i], QLatin1String("in")); };
+    auto text = [&](int i) { return Lexer::text(expr, tokens[i]).toString(); };
+    
+    // (item, index) in listName
+    if (isType(0, Token::LParen) && isName(1) && isType(2, Token::Comma) && isName(3) &&
+        isType(4, Token::RParen) && isIn(5) && isName(6) && isType(7, Token::End)) {
+        result.itemVar = text(1);
+        result.indexVar = text(3);
+        result.listName = text(6);
+        result.isValid = true;
+    }
+    // item in listName
+    else if (isName(0) && isIn(1) && isName(2) && isType(3, Token::End)) {
+        result.itemVar = text(0);
+        result.listName = text(2);
+        result.isValid = true;
+    }
     
-    if (leftOk && rightOk) {
-        // 数值比较
-        if (op == "==") {
-            // 处理浮点数精度问题
-            if (leftNum == 0.0 && rightNum == 0.0) return true;
-            return qFuzzyCompare(leftNum, rightNum);
+    return result;
+}
+
+QString ExpressionParser::substituteTemplate(const QString& tpl, const QString& itemVar, const QVariantMap& item,
+                                             const QString& indexVar, int index) {
+    if (!tpl.contains('$')) {
+        return tpl;
+    }
+    
+    QString result;
+    result.reserve(tpl.size());
+    const int size = tpl.size();
+    int pos = 0;
+    
+    while (pos < size) {
+        int dollar = tpl.indexOf('$', pos);
+        if (dollar < 0) {
+            appendView(result, QStringView(tpl).mid(pos));
+            break;
         }
-        if (op == "!=") {
-            if (leftNum == 0.0 && rightNum == 0.0) return false;
-            return !qFuzzyCompare(leftNum, rightNum);
+        appendView(result, QStringView(tpl).mid(pos, dollar - pos));
+        
+        int end = dollar + 1;
+        while (end < size && Lexer::isNameChar(tpl.at(end))) ++end;
+        QStringView name = QStringView(tpl).mid(dollar + 1, end - dollar - 1);
+        
+        // 取最长的可替换前缀：$idx、$item.key，剩余部分原样保留（如 $idx.name → 0.name）
+        QString replacement;
+        int consumed = -1;
+        for (int len = name.size(); len > 0; len = name.left(len).lastIndexOf('.')) {
+            QStringView prefix = name.left(len);
+            if (!indexVar.isEmpty() && prefix == QStringView(indexVar)) {
+                replacement = QString::number(index);
+                consumed = len;
+                break;
+            }
+            if (prefix.size() > itemVar.size() + 1 && prefix.startsWith(itemVar) && 
+                prefix.at(itemVar.size()) == QLatin1Char('.')) {
+                QString key = prefix.mid(itemVar.size() + 1).toString();
+                auto it = item.constFind(key);
+                if (it != item.constEnd()) {
+                    replacement = it.value().toString();
+                    consumed = len;
+                    break;
+                }
+            }
         }
-        if (op == ">")  return leftNum > rightNum;
-        if (op == "<")  return leftNum < rightNum;
-        if (op == ">=") return leftNum >= rightNum;
-        if (op == "<=") return leftNum <= rightNum;
+        
+        if (consumed < 0) {
+            appendView(result, QStringView(tpl).mid(dollar, end - dollar));
+        } else {
+            result.append(replacement);
+            appendView(result, name.mid(consumed));
+        }
+        pos = end;
     }
     
-    // 字符串比较
-    QString leftStr = left.toString();
-    QString rightStr = right.toString();
+    return result;
+}
+
+CompiledTemplate ExpressionParser::compileTemplate(const QString& tpl) {
+    CompiledTemplate result;
+    result.m_source = tpl;
     
-    if (op == "==") return leftStr == rightStr;
-    if (op == "!=") return leftStr != rightStr;
-    if (op == ">")  return leftStr > rightStr;
-    if (op == "<")  return leftStr < rightStr;
-    if (op == ">=") return leftStr >= rightStr;
-    if (op == "<=") return leftStr <= rightStr;
+    const int size = tpl.size();
+    int pos = 0;
+    while (true) {
+        int dollar = tpl.indexOf('$', pos);
+        if (dollar < 0) {
+            result.m_literals.append(tpl.mid(pos));
+            break;
+        }
+        result.m_literals.append(tpl.mid(pos, dollar - pos));
+        
+        int end = dollar + 1;
+        while (end < size && Lexer::isNameChar(tpl.at(end))) ++end;
+        result.m_references.append(tpl.mid(dollar + 1, end - dollar - 1));
+        pos = end;
+    }
     
-    return false;
+    return result;
+}
+
+QString CompiledTemplate::render(const QVector<TemplateScope>& scopes) const {
+    if (m_references.isEmpty()) {
+        return m_source;
+    }
+    
+    QString result;
+    result.reserve(m_source.size());
+    for (int i = 0; i < m_references.size(); ++i) {
+        result.append(m_literals.at(i));
+        
+        // 取最长的可替换前缀，同一前缀由内向外查找作用域
+        const QString& name = m_references.at(i);
+        QString replacement;
+        int consumed = -1;
+        const QStringView nameView(name);
+        for (int len = name.size(); len > 0 && consumed < 0;
+             len = int(nameView.left(len).lastIndexOf(QLatin1Char('.')))) {
+            QStringView prefix = nameView.left(len);
+            for (const TemplateScope& scope : scopes) {
+                if (!scope.indexVar.isEmpty() && prefix == QStringView(scope.indexVar)) {
+                    replacement = QString::number(scope.index);
+                    consumed = len;
+                    break;
+                }
+                if (prefix.size() > scope.itemVar.size() + 1 && prefix.startsWith(scope.itemVar) &&
+                    prefix.at(scope.itemVar.size()) == QLatin1Char('.')) {
+                    auto it = scope.item.constFind(prefix.mid(scope.itemVar.size() + 1).toString());
+                    if (it != scope.item.constEnd()) {
+                        replacement = it.value().toString();
+                        consumed = len;
+                        break;
+                    }
+                }
+            }
+        }
+        
+        if (consumed < 0) {
+            result.append('$');
+            result.append(name);
+        } else {
+            result.append(replacement);
+            appendView(result, nameView.mid(consumed));
+        }
+    }
+    result.append(m_literals.last());
+    
+    return result;
+}
+
+QString ExpressionParser::normalize(const QString& expr) {
+    CompiledExpression compiled = compile(expr);
+    return compiled.isValid() ? compiled.toString() : expr.trimmed();
+}
+
+QString ExpressionParser::toString(const Condition& condition) {
+    if (!condition.isValid) {
+        return QString();
+    }
+    
+    // 字符串加引号，保证重新编译后含空格/括号的值和数字形式的字符串不变
+    auto literal = [](const QVariant& value) -> QString {
+        if (value.type() != QVariant::String) {
+            return value.toString();
+        }
+        QString text = value.toString();
+        QChar quote = text.contains('"') ? '\'' : '"';
+        return quote + text + quote;
+    };
+    
+    if (condition.op == "in" || condition.op == "not in") {
+        QStringList items;
+        for (const QVariant& value : condition.compareValue.toList()) {
+            items.append(literal(value));
+        }
+        return "$" + condition.variable + " " + condition.op + " [" + items.join(", ") + "]";
+    }
+    
+    QString right = condition.isRightVariable ? "$" + condition.compareVariable 
+                                              : literal(condition.compareValue);
+    return "$" + condition.variable + condition.op + right;
+}
+
+bool ExpressionParser::compareValues(const QVariant& left, const QString& op, const QVariant& right) {
+    return compareValues(left, compareOpFromString(op), right);
+}
+
+bool ExpressionParser::compareValues(const QVariant& left, CompareOp op, const QVariant& right) {
+    // 优先尝试数值比较（支持 >, <, >=, <= 等运算符）
+    double leftNum, rightNum;
+    if (toNumber(left, leftNum) && toNumber(right, rightNum)) {
+        return applyCompare<double>(op, leftNum, rightNum);
+    }
+    
+    // 字符串比较
+    return applyCompare<QString>(op, left.toString(), right.toString());
 }
 
 } // namespace Quik
@@ -5,20 +5,64 @@
 #include <QString>
 #include <QVariant>
 #include <QVariantMap>
+#include <QVector>
+#include <QStringList>
+#include <QSet>
 
 namespace Quik {
 
+/**
+ * @brief 比较运算符
+ */
+enum class CompareOp {
+    Invalid,
+    Equal,          // ==
+    NotEqual,       // !=
+    Greater,        // >
+    Less,           // <
+    GreaterEqual,   // >=
+    LessEqual,      // <=
+    In,             // in [a, b, c]
+    NotIn           // not in [a, b, c]
+};
+
+/**
+ * @brief 右侧常量的类型（解析时确定）
+ */
+enum class LiteralType {
+    None,           // 未分类（右侧是变量，或手工构造的条件）
+    Integer,        // 整数，如 1
+    Double,         // 浮点数，如 0.5
+    String,         // 非数值字符串，如 On
+    Set             // 集合常量，如 [1, 2, On]
+};
+
 /**
  * @brief 条件表达式结构体
  * 用于存储解析后的表达式，如 "$varName==value" 或 "$var1==$var2"
+ * 
+ * 解析时确定运算符和右侧常量的类型，求值时直接选择对应的比较函数，
+ * 不再比较运算符字符串，也不再对常量做 toDouble/toString 转换。
+ * 
+ * 集合运算 "$mode in [a, b, c]" 的常量在解析时分类：字符串放入哈希集合（常数次查找），
+ * 数值排序去重后二分查找。数值与 == 一样按模糊比较匹配，只需检查二分定位到的
+ * 容差窗口，一次求值为 O(log n)。
  */
 struct QUIK_API Condition {
     QString variable;           // 左侧变量名（不含$前缀）
-    QString op;                 // 运算符: ==, !=, >, <, >=, <=
-    QVariant compareValue;      // 比较值（如果右侧是固定值）
+    QString op;                 // 运算符: ==, !=, >, <, >=, <=, in, not in
+    QVariant compareValue;      // 比较值（如果右侧是固定值；in/not in 时为 QVariantList）
     QString compareVariable;    // 右侧变量名（如果右侧也是变量，不含$前缀）
     bool isRightVariable = false;  // 右侧是否是变量
     bool isValid = false;       // 是否解析成功
+    
+    CompareOp compareOp = CompareOp::Invalid;       // 运算符（枚举）
+    LiteralType literalType = LiteralType::None;    // 右侧常量类型
+    qint64 literalInt = 0;      // 整数常量
+    double literalDouble = 0.0; // 数值常量（整数常量也会设置）
+    QString literalText;        // 常量的字符串形式（左侧不是数值时按字符串比较）
+    QVector<double> numberSet;  // 集合中的数值常量（in/not in），升序且不重复
+    QSet<QString> stringSet;    // 集合中的字符串常量（in/not in）
 };
 
 /**
@@ -32,6 +76,181 @@ struct QUIK_API CompoundCondition {
     bool isValid = false;
 };
 
+/**
+ * @brief q-for 表达式结构体
+ * 对应 "item in listName" 或 "(item, index) in listName"
+ */
+struct QUIK_API QForExpression {
+    QString itemVar;            // 循环变量名
+    QString indexVar;           // 索引变量名（可为空）
+    QString listName;           // 数据源名称
+    bool isValid = false;       // 是否解析成功
+};
+
+/**
+ * @brief q-for 模板的一层作用域（循环变量和当前项）
+ */
+struct QUIK_API TemplateScope {
+    QString itemVar;            // 循环变量名
+    QVariantMap item;           // 当前项
+    QString indexVar;           // 索引变量名（可为空）
+    int index = 0;              // 当前索引
+};
+
+/**
+ * @brief 预先切分的 q-for 模板
+ * 
+ * 由 ExpressionParser::compileTemplate 生成：模板在注册时切分为文本片段和 $ 引用，
+ * 每行渲染只拼接片段、解析引用，不再扫描整个模板。引用按作用域由内向外解析，
+ * 内层的同名循环变量遮蔽外层，规则与 substituteTemplate 相同。
+ * 
+ * 使用示例：
+ * @code
+ * CompiledTemplate tpl = ExpressionParser::compileTemplate(
+ *     "<LineEdit title=\"$group.name / $field.label\" var=\"groups.$gi.fields.$fi\"/>");
+ * TemplateScope inner;
+ * inner.itemVar = "field";
+ * inner.item = field;
+ * inner.indexVar = "fi";
+ * inner.index = 2;
+ * QString xml = tpl.render(QVector<TemplateScope>() << inner << outer);   // 内层在前
+ * @endcode
+ */
+class QUIK_API CompiledTemplate {
+public:
+    /**
+     * @brief 原始模板
+     */
+    const QString& source() const { return m_source; }
+    
+    /**
+     * @brief 模板中的 $ 引用数
+     */
+    int referenceCount() const { return m_references.size(); }
+    
+    /**
+     * @brief 渲染模板
+     * @param scopes 作用域，内层在前
+     * @return 替换后的字符串，未知的 $xxx 原样保留
+     */
+    QString render(const QVector<TemplateScope>& scopes) const;
+    
+private:
+    friend class ExpressionParser;
+    
+    QString m_source;
+    QStringList m_literals;         // 文本片段，比引用多一个
+    QStringList m_references;       // $ 之后的名称（不含$）
+};
+
+/**
+ * @brief 编译后的条件表达式
+ * 
+ * 由 ExpressionParser::compile 生成的表达式树，支持 and/or/not（及 &&、||、!）、括号
+ * 和集合运算 in/not in，and 的优先级高于 or。节点以扁平数组存储，求值时直接遍历树并短路：
+ * and 遇到 false、or 遇到 true 立即返回，不再重写或重新解析字符串。
+ * 
+ * 使用示例：
+ * @code
+ * CompiledExpression expr = ExpressionParser::compile("$mode in [1, 3, 5] and ($a>0 or not $b==2)");
+ * bool visible = expr.evaluate(context);
+ * @endcode
+ */
+class QUIK_API CompiledExpression {
+public:
+    /**
+     * @brief 是否编译成功
+     */
+    bool isValid() const { return m_root >= 0; }
+    
+    /**
+     * @brief 原始表达式字符串
+     */
+    const QString& source() const { return m_source; }
+    
+    /**
+     * @brief 表达式中的所有比较（按出现顺序）
+     */
+    const QList<Condition>& leaves() const { return m_leaves; }
+    
+    /**
+     * @brief 表达式是否只是单个比较（可能带括号）
+     */
+    bool isSingleCondition() const { return isValid() && m_nodes[m_root].kind == NodeKind::Compare; }
+    
+    /**
+     * @brief 表达式依赖的变量（去重）
+     */
+    QStringList variables() const;
+    
+    /**
+     * @brief 规范形式的字符串（只在需要时加括号）
+     */
+    QString toString() const;
+    
+    /**
+     * @brief 在变量上下文中求值（短路）
+     * @param context 变量上下文
+     * @return 求值结果，未编译成功时返回false
+     */
+    bool evaluate(const QVariantMap& context) const;
+    
+    /**
+     * @brief 使用自定义的比较求值函数求值（短路）
+     * @param leaf 函数 bool(int leafIndex, const Condition&)，只对实际需要的比较调用
+     * 
+     * 供 QuikContext 复用共享子条件的结果。
+     */
+    template<typename LeafEvaluator>
+    bool evaluate(LeafEvaluator leaf) const {
+        return isValid() && evaluateNode(m_root, leaf);
+    }
+    
+private:
+    enum class NodeKind { Or, And, Not, Compare };
+    
+    struct Node {
+        NodeKind kind;
+        int first = 0;      // 子节点在 m_children 中的起始位置（Or/And/Not）
+        int count = 0;      // 子节点数
+        int leaf = -1;      // 比较在 m_leaves 中的索引（Compare）
+    };
+    
+    template<typename LeafEvaluator>
+    bool evaluateNode(int index, LeafEvaluator& leaf) const {
+        const Node& node = m_nodes[index];
+        switch (node.kind) {
+        case NodeKind::Or:
+            for (int i = 0; i < node.count; ++i) {
+                if (evaluateNode(m_children[node.first + i], leaf)) return true;
+            }
+            return false;
+        case NodeKind::And:
+            for (int i = 0; i < node.count; ++i) {
+                if (!evaluateNode(m_children[node.first + i], leaf)) return false;
+            }
+            return true;
+        case NodeKind::Not:
+            return !evaluateNode(m_children[node.first], leaf);
+        case NodeKind::Compare:
+            return leaf(node.leaf, m_leaves[node.leaf]);
+        }
+        return false;
+    }
+    
+    QString nodeToString(int index) const;
+    
+    class Parser;
+    friend class ExpressionParser;
+    friend class BatchEvaluator;
+    
+    QString m_source;
+    QVector<Node> m_nodes;
+    QVector<int> m_children;
+    QList<Condition> m_leaves;
+    int m_root = -1;
+};
+
 /**
  * @brief 表达式解析器
  * 负责解析和求值条件表达式，如 visible="$chkStitch==0"
@@ -52,6 +271,14 @@ public:
      */
     static CompoundCondition parseCompound(const QString& expr);
     
+    /**
+     * @brief 编译条件表达式为表达式树
+     * @param expr 表达式字符串，支持 and/or/not、&&/||/!、括号，比较的右侧可以是 $变量、数值、
+     *             字符串（可用单/双引号包围），以及 "$x in [a, b]"、"$x not in [a, b]"
+     * @return 编译结果，语法错误时 isValid() 为false（并输出一次警告）
+     */
+    static CompiledExpression compile(const QString& expr);
+    
     /**
      * @brief 求值条件表达式
      * @param condition 已解析的条件
@@ -77,7 +304,15 @@ public:
     static bool evaluate(const CompoundCondition& compound, const QVariantMap& context);
     
     /**
-     * @brief 检查字符串是否是表达式（以$开头）
+     * @brief 求值算术表达式
+     * @param expr 表达式字符串，支持 + - * / %、一元负号、括号、数值和 $变量，如 "$w * $h"
+     * @param context 变量上下文
+     * @return 计算结果（double），变量缺失/非数值/结果非有限数时返回无效QVariant
+     */
+    static QVariant evaluateArithmetic(const QString& expr, const QVariantMap& context);
+    
+    /**
+     * @brief 检查字符串是否是表达式（以 $、(、! 或 not 开头）
      * @param str 待检查的字符串
      * @return 是否是表达式
      */
@@ -89,10 +324,66 @@ public:
      * @return 变量名列表
      */
     static QStringList extractVariables(const QString& expr);
+    
+    /**
+     * @brief 解析 q-for 表达式
+     * @param expr 如 "item in modes" 或 "(item, idx) in modes"
+     * @return 解析结果，格式错误时 isValid 为false
+     */
+    static QForExpression parseQFor(const QString& expr);
+    
+    /**
+     * @brief 替换 q-for 模板中的循环变量（单遍扫描）
+     * @param tpl 模板字符串，如 "$item.label" 或 var="formData.$idx.name"
+     * @param itemVar 循环变量名
+     * @param item 当前项数据
+     * @param indexVar 索引变量名（可为空）
+     * @param index 当前索引
+     * @return 替换后的字符串，未知的 $xxx 原样保留
+     */
+    static QString substituteTemplate(const QString& tpl, const QString& itemVar, const QVariantMap& item,
+                                      const QString& indexVar, int index);
+    
+    /**
+     * @brief 预先切分 q-for 模板，供每行渲染复用
+     * @param tpl 模板字符串
+     */
+    static CompiledTemplate compileTemplate(const QString& tpl);
+    
+    /**
+     * @brief 规范化表达式（用于识别等价表达式）
+     * @param expr 表达式字符串
+     * @return 规范形式，如 " $cmbType == 1 " 和 "cmbType==1" 都得到 "$cmbType==1"
+     * 
+     * 简单条件和 and/or 复合条件按解析结果重新生成，逻辑运算符统一为小写；
+     * 含括号的表达式只去除首尾空白。规范形式与原表达式求值结果相同。
+     */
+    static QString normalize(const QString& expr);
+    
+    /**
+     * @brief 根据运算符和右侧常量填充条件的类型信息（parse/compile 已自动调用）
+     * @param condition 条件，手工构造后调用可获得与解析结果相同的求值速度
+     */
+    static void classify(Condition& condition);
+    
+    /**
+     * @brief 数值是否在集合条件的数值常量中（与 == 相同的模糊比较，二分查找）
+     * @param condition 已分类的 in/not in 条件
+     * @param value 左侧的数值，NaN 不匹配任何常量
+     */
+    static bool containsNumber(const Condition& condition, double value);
+    
+    /**
+     * @brief 将条件转换为规范的表达式字符串
+     * @param condition 已解析的条件
+     * @return 表达式字符串，如 "$a==1" 或 "$a>=$b"
+     */
+    static QString toString(const Condition& condition);
 
 private:
     static bool compareValues(const QVariant& left, const QString& op, const QVariant& right);
-    static bool evaluateWithParentheses(const QString& expr, const QVariantMap& context);
+    static bool compareValues(const QVariant& left, CompareOp op, const QVariant& right);
+    static bool compareLiteral(const QVariant& left, const Condition& condition);
 };
 
 } // namespace Quik
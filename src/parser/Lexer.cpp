@@ -0,0 +1,124 @@
+#include "Lexer.h"
+
+namespace Quik {
+
+namespace {
+
+// 分隔 Word 的特殊字符
+bool isSpecialChar(QChar c) {
+    switch (c.unicode()) {
+    case '$': case '(': case ')': case '[': case ']': case ',':
+    case '=': case '!': case '<': case '>': case '&': case '|':
+    case '"': case '\'':
+        return true;
+    default:
+        return false;
+    }
+}
+
+Token makeToken(Token::Type type, int position, int end, int start, int length) {
+    Token token;
+    token.type = type;
+    token.position = position;
+    token.end = end;
+    token.start = start;
+    token.length = length;
+    return token;
+}
+
+} // anonymous namespace
+
+QVector<Token> Lexer::tokenize(const QString& source) {
+    QVector<Token> tokens;
+    const int size = source.size();
+    int pos = 0;
+
+    while (true) {
+        while (pos < size && source.at(pos).isSpace()) ++pos;
+        if (pos >= size) break;
+
+        const int begin = pos;
+        const QChar c = source.at(pos);
+        const QChar next = pos + 1 < size ? source.at(pos + 1) : QChar();
+
+        switch (c.unicode()) {
+        case '$': {
+            ++pos;
+            while (pos < size && isNameChar(source.at(pos))) ++pos;
+            tokens.append(makeToken(Token::Variable, begin, pos, begin + 1, pos - begin - 1));
+            continue;
+        }
+        case '"':
+        case '\'': {
+            int close = source.indexOf(c, pos + 1);
+            if (close < 0) {
+                tokens.append(makeToken(Token::Error, begin, size, begin, size - begin));
+                pos = size;
+            } else {
+                tokens.append(makeToken(Token::String, begin, close + 1, begin + 1, close - begin - 1));
+                pos = close + 1;
+            }
+            continue;
+        }
+        case '(': tokens.append(makeToken(Token::LParen, begin, begin + 1, begin, 1)); ++pos; continue;
+        case ')': tokens.append(makeToken(Token::RParen, begin, begin + 1, begin, 1)); ++pos; continue;
+        case '[': tokens.append(makeToken(Token::LBracket, begin, begin + 1, begin, 1)); ++pos; continue;
+        case ']': tokens.append(makeToken(Token::RBracket, begin, begin + 1, begin, 1)); ++pos; continue;
+        case ',': tokens.append(makeToken(Token::Comma, begin, begin + 1, begin, 1)); ++pos; continue;
+        case '=':
+        case '!':
+        case '<':
+        case '>':
+            // == != >= <=，以及单字符的 > < !
+            if (next == QLatin1Char('=')) {
+                pos += 2;
+            } else if (c == QLatin1Char('=')) {
+                tokens.append(makeToken(Token::Error, begin, begin + 1, begin, 1));
+                ++pos;
+                continue;
+            } else {
+                ++pos;
+            }
+            tokens.append(makeToken(Token::Operator, begin, pos, begin, pos - begin));
+            continue;
+        case '&':
+        case '|':
+            if (next == c) {
+                pos += 2;
+                tokens.append(makeToken(Token::Operator, begin, pos, begin, 2));
+            } else {
+                ++pos;
+                tokens.append(makeToken(Token::Error, begin, pos, begin, 1));
+            }
+            continue;
+        default:
+            break;
+        }
+
+        // Word：连续的非空白、非特殊字符
+        while (pos < size && !source.at(pos).isSpace() && !isSpecialChar(source.at(pos))) ++pos;
+        tokens.append(makeToken(Token::Word, begin, pos, begin, pos - begin));
+    }
+
+    tokens.append(makeToken(Token::End, size, size, size, 0));
+    return tokens;
+}
+
+bool Lexer::isKeyword(const QString& source, const Token& token, QLatin1String keyword) {
+    return token.type == Token::Word &&
+           text(source, token).compare(keyword, Qt::CaseInsensitive) == 0;
+}
+
+bool Lexer::isOperator(const QString& source, const Token& token, QLatin1String op) {
+    return token.type == Token::Operator && text(source, token) == op;
+}
+
+bool Lexer::isName(const QString& source, const Token& token) {
+    if (token.type != Token::Word || token.length == 0) return false;
+    for (int i = token.start; i < token.start + token.length; ++i) {
+        if (!isNameChar(source.at(i))) return false;
+    }
+    return true;
+}
+
+} // namespace Quik
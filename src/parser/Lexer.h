@@ -0,0 +1,94 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include "Quik/QuikAPI.h"
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+namespace Quik {
+
+/**
+ * @brief 词法单元
+ *
+ * 只记录在源字符串中的位置，不复制文本；需要文本时通过 Lexer::text 取 QStringView。
+ */
+struct QUIK_API Token {
+    enum Type {
+        Variable,   // $name（文本不含$）
+        Word,       // 标识符、数值、关键字（and/or/not/in）或裸字符串片段
+        String,     // 引号字符串（文本不含引号）
+        Operator,   // == != >= <= > < && || !
+        LParen,     // (
+        RParen,     // )
+        LBracket,   // [
+        RBracket,   // ]
+        Comma,      // ,
+        Error,      // 无法识别的字符或未闭合的字符串
+        End         // 结束
+    };
+
+    Type type = End;
+    int start = 0;      // 文本起始位置
+    int length = 0;     // 文本长度
+    int position = 0;   // 词法单元起始位置（含$和引号）
+    int end = 0;        // 词法单元结束位置（不含）
+};
+
+/**
+ * @brief 表达式与 q-for 语法共用的词法分析器
+ *
+ * 单遍扫描，不使用正则表达式，除返回的 Token 列表外不分配内存。
+ * 空白只作为分隔符；除 $()[],=!<>&|"' 和空白外的连续字符组成一个 Word，
+ * 因此 "1e-3"、"-1"、"选项A" 都是单个 Word。
+ *
+ * 使用示例：
+ * @code
+ * QString src = "$mode==1 and $name!='a b'";
+ * for (const Token& token : Lexer::tokenize(src)) {
+ *     qDebug() << token.type << Lexer::text(src, token);
+ * }
+ * @endcode
+ */
+class QUIK_API Lexer {
+public:
+    /**
+     * @brief 分词
+     * @param source 源字符串
+     * @return 词法单元列表，总是以 End 结尾
+     */
+    static QVector<Token> tokenize(const QString& source);
+
+    /**
+     * @brief 获取词法单元的文本
+     */
+    static QStringView text(const QString& source, const Token& token) {
+        return QStringView(source).mid(token.start, token.length);
+    }
+
+    /**
+     * @brief 是否是指定的关键字（Word，不区分大小写）
+     */
+    static bool isKeyword(const QString& source, const Token& token, QLatin1String keyword);
+
+    /**
+     * @brief 是否是指定的运算符
+     */
+    static bool isOperator(const QString& source, const Token& token, QLatin1String op);
+
+    /**
+     * @brief 是否是名称字符（变量名可包含字母、数字、下划线和点号）
+     */
+    static bool isNameChar(QChar c) {
+        return c.isLetterOrNumber() || c == QLatin1Char('_') || c == QLatin1Char('.');
+    }
+
+    /**
+     * @brief Word 是否是合法名称（只含名称字符）
+     */
+    static bool isName(const QString& source, const Token& token);
+};
+
+} // namespace Quik
+
+#endif // LEXER_H
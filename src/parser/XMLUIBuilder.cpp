@@ -1,11 +1,13 @@
 #include "XMLUIBuilder.h"
 #include "Quik/Quik.h"
+#include "core/QuikTrace.h"
 #include <QFile>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFormLayout>
 #include <QGroupBox>
 #include <QPushButton>
+#include <QAbstractButton>
 #include <QLabel>
 #include <QLineEdit>
 #include <QDebug>
@@ -13,7 +15,6 @@
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QTextStream>
-#include <QRegularExpression>
 
 namespace Quik {
 
@@ -50,11 +51,18 @@ QWidget* XMLUIBuilder::buildFromFile(const QString& filePath, QWidget* parent) {
 }
 
 QWidget* XMLUIBuilder::buildFromString(const QString& xmlContent, QWidget* parent) {
+    QUIK_TRACE_SCOPE("build");
+    
     QDomDocument doc;
     QString errorMsg;
     int errorLine, errorColumn;
     
-    if (!doc.setContent(xmlContent, &errorMsg, &errorLine, &errorColumn)) {
+    bool parsed;
+    {
+        QUIK_TRACE_SCOPE_DETAIL("parse", QString("%1 bytes").arg(xmlContent.size()));
+        parsed = doc.setContent(xmlContent, &errorMsg, &errorLine, &errorColumn);
+    }
+    if (!parsed) {
         QString error = QString("XML parse error at line %1, column %2: %3")
                         .arg(errorLine).arg(errorColumn).arg(errorMsg);
         qWarning() << "[Quik]" << error;
@@ -88,6 +96,49 @@ QWidget* XMLUIBuilder::buildFromString(const QString& xmlContent, QWidget* paren
     return m_rootWidget;
 }
 
+bool XMLUIBuilder::buildModelFromFile(const QString& filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QString error = QString("Cannot open file: %1").arg(filePath);
+        qWarning() << "[Quik]" << error;
+        emit buildError(error);
+        return false;
+    }
+    
+    return buildModel(QString::fromUtf8(file.readAll()));
+}
+
+bool XMLUIBuilder::buildModel(const QString& xmlContent) {
+    QUIK_TRACE_SCOPE("buildModel");
+    
+    QDomDocument doc;
+    QString errorMsg;
+    int errorLine, errorColumn;
+    if (!doc.setContent(xmlContent, &errorMsg, &errorLine, &errorColumn)) {
+        QString error = QString("XML parse error at line %1, column %2: %3")
+                        .arg(errorLine).arg(errorColumn).arg(errorMsg);
+        qWarning() << "[Quik]" << error;
+        emit buildError(error);
+        return false;
+    }
+    
+    QDomElement root = doc.documentElement();
+    if (root.isNull()) {
+        emit buildError("Empty XML document");
+        return false;
+    }
+    
+    qDebug() << "[Quik] Building headless model from root element:" << root.tagName();
+    
+    processModelChildren(root, QString());
+    
+    // 初始化所有绑定（计算变量和字段状态）
+    m_context->initializeBindings();
+    
+    qDebug() << "[Quik] Model build completed:" << m_context->fields().size() << "fields";
+    return true;
+}
+
 QWidget* XMLUIBuilder::getWidget(const QString& varName) const {
     return m_context->getWidget(varName);
 }
@@ -100,6 +151,10 @@ void XMLUIBuilder::setValue(const QString& varName, const QVariant& value) {
     m_context->setValue(varName, value);
 }
 
+void XMLUIBuilder::postValue(const QString& varName, const QVariant& value) {
+    m_context->postValue(varName, value);
+}
+
 void XMLUIBuilder::connectButton(const QString& varName, std::function<void()> callback) {
     // 保存回调以便热更新后重新连接
     m_buttonCallbacks[varName] = callback;
@@ -119,11 +174,13 @@ QVariantMap XMLUIBuilder::getAllValues() const {
 void XMLUIBuilder::watch(const QString& varName, std::function<void(const QVariant&)> callback) {
     // 保存回调以便热更新后重新连接
     m_watchCallbacks[varName] = callback;
+    m_watchSites[varName] = WatchSite::current();
     m_context->watch(varName, callback);
 }
 
 void XMLUIBuilder::unwatch(const QString& varName) {
     m_watchCallbacks.remove(varName);
+    m_watchSites.remove(varName);
     m_context->unwatch(varName);
 }
 
@@ -340,6 +397,8 @@ void XMLUIBuilder::onFileChanged(const QString& path) {
 }
 
 void XMLUIBuilder::reload() {
+    QUIK_TRACE_SCOPE("hotReload");
+    
     if (m_currentFilePath.isEmpty()) {
         qWarning() << "[Quik] No file path set for reload";
         return;
@@ -437,6 +496,7 @@ void XMLUIBuilder::reload() {
     
     // 8. 重新连接watch回调
     for (auto it = m_watchCallbacks.begin(); it != m_watchCallbacks.end(); ++it) {
+        WatchSiteScope site(m_watchSites.value(it.key()));
         m_context->watch(it.key(), it.value());
     }
     
@@ -444,14 +504,36 @@ void XMLUIBuilder::reload() {
     emit reloaded();
 }
 
+MemoryStats XMLUIBuilder::memoryStats() const {
+    MemoryStats stats = m_context->memoryStats();
+    
+    // 整棵组件树
+    if (m_rootWidget) {
+        stats.widgets = m_rootWidget->findChildren<QWidget*>().size() + 1;
+        stats.widgetBytes = qint64(stats.widgets) * MemoryStats::EstimatedWidgetBytes;
+    }
+    
+    // 构建器保存的数据源（热更新时恢复用），通常与上下文共享
+    for (auto it = m_listData.constBegin(); it != m_listData.constEnd(); ++it) {
+        if (!it.value().isSharedWith(m_context->getListData(it.key()))) {
+            stats.listDataBytes += MemoryStats::sizeOf(QVariant(it.value()));
+        }
+    }
+    
+    return stats;
+}
+
 bool XMLUIBuilder::isValid() const {
     return getValidationErrors().isEmpty();
 }
 
 QMap<QString, QString> XMLUIBuilder::getValidationErrors() const {
-    QMap<QString, QString> errors;
+    // 无界面模型：按当前值校验生效的字段
+    if (!m_rootWidget) {
+        return m_context->validationErrors();
+    }
     
-    if (!m_rootWidget) return errors;
+    QMap<QString, QString> errors;
     
     // 遍历所有LineEdit检查验证状态
     QList<QLineEdit*> lineEdits = m_rootWidget->findChildren<QLineEdit*>();
@@ -472,14 +554,19 @@ QMap<QString, QString> XMLUIBuilder::getValidationErrors() const {
 QWidget* XMLUIBuilder::buildElement(const QDomElement& element, QWidget* parent) {
     QString tagName = element.tagName();
     
-    // 跳过Choice元素（由ComboBox内部处理）
-    if (tagName == "Choice") {
+    // 跳过Choice元素（由ComboBox内部处理）和非组件元素
+    if (tagName == "Choice" || tagName == "Computed") {
         return nullptr;
     }
     
     // 使用工厂创建组件
     QWidget* widget = WidgetFactory::instance().create(tagName, element, m_context);
     
+    // q-for 行中需要改绑的组件记录模板中的编号
+    if (widget && element.hasAttribute("_qpath")) {
+        widget->setProperty("_Quik_qpath", element.attribute("_qpath").toInt());
+    }
+    
     if (!widget) {
         // 创建错误占位符，显示未知标签
         QString error = QString("Unknown tag: <%1>").arg(tagName);
@@ -501,6 +588,8 @@ QWidget* XMLUIBuilder::buildElement(const QDomElement& element, QWidget* parent)
 }
 
 void XMLUIBuilder::processChildren(const QDomElement& element, QWidget* container) {
+    QUIK_TRACE_SCOPE_DETAIL("processChildren", element.tagName());
+    
     QLayout* layout = container->layout();
     if (!layout) {
         layout = new QVBoxLayout(container);
@@ -518,6 +607,13 @@ void XMLUIBuilder::processChildren(const QDomElement& element, QWidget* containe
             continue;
         }
         
+        // 计算变量：<Computed var="area" expr="$w * $h"/>
+        if (tagName == "Computed") {
+            m_context->registerComputed(child.attribute("var"), child.attribute("expr"));
+            child = child.nextSiblingElement();
+            continue;
+        }
+        
         // 处理addStretch
         if (tagName == "addStretch") {
             int stretch = child.attribute("stretch", "1").toInt();
@@ -528,6 +624,17 @@ void XMLUIBuilder::processChildren(const QDomElement& element, QWidget* containe
             continue;
         }
         
+        // 嵌套 q-for 的位置：按正在渲染的行的作用域实例化已编译的内层
+        if (tagName == "QForSlot") {
+            int index = child.attribute("index").toInt();
+            if (m_renderingLevel && index >= 0 && index < m_renderingLevel->nested.size() &&
+                m_renderingLevel->nested.at(index)) {
+                instantiateQFor(m_renderingLevel->nested.at(index), container, m_renderingScopes);
+            }
+            child = child.nextSiblingElement();
+            continue;
+        }
+        
         // ========== 处理通用 q-for ==========
         QString qFor = child.attribute("q-for");
         if (!qFor.isEmpty()) {
@@ -598,6 +705,7 @@ void XMLUIBuilder::processChildren(const QDomElement& element, QWidget* containe
 
 QWidget* XMLUIBuilder::createLabeledRow(const QString& title, QWidget* widget) {
     auto* row = new QWidget();
+    row->setProperty("_Quik_labeledRow", true);
     auto* layout = new QHBoxLayout(row);
     layout->setContentsMargins(0, 0, 0, 0);
     layout->setSpacing(10);
@@ -629,43 +737,176 @@ bool XMLUIBuilder::isLayoutTag(const QString& tagName) const {
 
 // ========== 通用 q-for 实现 ==========
 
-void XMLUIBuilder::processGeneralQFor(const QDomElement& element, QWidget* container, const QString& qForExpr) {
-    // 解析 q-for 表达式
-    QString itemVar, indexVar, listName;
-    
-    // 尝试匹配带索引的格式: (item, index) in listName
-    QRegularExpression reWithIndex("\\(\\s*(\\w+)\\s*,\\s*(\\w+)\\s*\\)\\s+in\\s+(\\w+)");
-    QRegularExpressionMatch matchWithIndex = reWithIndex.match(qForExpr);
+namespace {
+
+// 改绑时重新应用的属性；其余属性引用了循环变量的模板只能重新渲染
+bool isRebindableAttribute(const QString& tagName, const QString& name) {
+    static const QStringList common = {"var", "default", "visible", "enabled", "tooltip"};
+    static const QStringList textTags = {"Label", "CheckBox", "RadioButton", "PushButton", "GroupBox"};
+    static const QStringList labeledTags = {"LineEdit", "ComboBox", "SpinBox", "DoubleSpinBox"};
+    if (common.contains(name)) return true;
+    if (name == "title") return textTags.contains(tagName) || labeledTags.contains(tagName);
+    if (name == "text") return textTags.contains(tagName);
+    return false;
+}
+
+bool referencesLoopVariables(const QString& value, const QString& itemVar, const QString& indexVar) {
+    return value.contains("$" + itemVar) || (!indexVar.isEmpty() && value.contains("$" + indexVar));
+}
+
+/**
+ * 给模板中改绑时需要更新的元素编号（_qpath 属性，渲染时记录到组件上）
+ * 模板中有无法改绑的部分（其他属性、Choice、嵌套 q-for 引用循环变量）时返回 false
+ */
+bool annotateRebindable(QDomElement element, const QString& itemVar, const QString& indexVar, int& nextPath) {
+    const QString tagName = element.tagName();
+    
+    // Choice 的 q-for 有自己的模板，引用外层循环变量时改绑无法更新它
+    if (element.hasAttribute("q-for")) {
+        QString xml;
+        QTextStream stream(&xml);
+        element.save(stream, 0);
+        return !referencesLoopVariables(xml, itemVar, indexVar);
+    }
     
-    if (matchWithIndex.hasMatch()) {
-        itemVar = matchWithIndex.captured(1);
-        indexVar = matchWithIndex.captured(2);
-        listName = matchWithIndex.captured(3);
-    } else {
-        // 尝试匹配简单格式: item in listName
-        QRegularExpression reSimple("(\\w+)\\s+in\\s+(\\w+)");
-        QRegularExpressionMatch matchSimple = reSimple.match(qForExpr);
-        if (matchSimple.hasMatch()) {
-            itemVar = matchSimple.captured(1);
-            listName = matchSimple.captured(2);
+    bool rebindable = true;
+    bool annotate = false;
+    
+    QDomNamedNodeMap attributes = element.attributes();
+    for (int i = 0; i < attributes.count(); ++i) {
+        QDomAttr attr = attributes.item(i).toAttr();
+        bool referenced = referencesLoopVariables(attr.value(), itemVar, indexVar);
+        if (tagName == "Choice" || tagName == "Item" || tagName == "Computed") {
+            rebindable = rebindable && !referenced;
+        } else if (isRebindableAttribute(tagName, attr.name())) {
+            annotate = annotate || referenced ||
+                       attr.name() == "var" || attr.name() == "visible" || attr.name() == "enabled";
+        } else {
+            rebindable = rebindable && !referenced;
         }
     }
+    if (annotate) {
+        element.setAttribute("_qpath", nextPath++);
+    }
     
-    if (itemVar.isEmpty() || listName.isEmpty()) {
+    for (QDomElement child = element.firstChildElement(); !child.isNull(); child = child.nextSiblingElement()) {
+        rebindable = annotateRebindable(child, itemVar, indexVar, nextPath) && rebindable;
+    }
+    return rebindable;
+}
+
+// 模板中最外层的嵌套 q-for 元素（更深的由它们各自编译）
+void collectNestedQFor(const QDomElement& element, QList<QDomElement>& nested) {
+    for (QDomElement child = element.firstChildElement(); !child.isNull(); child = child.nextSiblingElement()) {
+        if (child.hasAttribute("q-for") && child.tagName() != "Choice") {
+            nested.append(child);
+        } else {
+            collectNestedQFor(child, nested);
+        }
+    }
+}
+
+void collectRebindPaths(const QDomElement& element, QHash<int, QDomElement>& elements) {
+    if (element.hasAttribute("_qpath")) {
+        elements.insert(element.attribute("_qpath").toInt(), element);
+    }
+    for (QDomElement child = element.firstChildElement(); !child.isNull(); child = child.nextSiblingElement()) {
+        collectRebindPaths(child, elements);
+    }
+}
+
+} // anonymous namespace
+
+void XMLUIBuilder::processGeneralQFor(const QDomElement& element, QWidget* container, const QString& qForExpr) {
+    std::shared_ptr<QForLevel> level = compileQFor(element, qForExpr, QStringList());
+    if (level) {
+        instantiateQFor(level, container, QVector<TemplateScope>());
+    }
+}
+
+std::shared_ptr<XMLUIBuilder::QForLevel> XMLUIBuilder::compileQFor(const QDomElement& element, const QString& qForExpr,
+                                                                   const QStringList& enclosingItemVars) {
+    // 解析 q-for 表达式: "item in listName" 或 "(item, index) in listName"
+    QForExpression qFor = ExpressionParser::parseQFor(qForExpr);
+    if (!qFor.isValid) {
         qWarning() << "[Quik] Invalid q-for expression:" << qForExpr;
-        return;
+        return nullptr;
+    }
+    QString itemVar = qFor.itemVar;
+    QString indexVar = qFor.indexVar;
+    QString listName = qFor.listName;
+    
+    auto level = std::make_shared<QForLevel>();
+    level->loop = qFor;
+    
+    // 嵌套时列表可以是任一外层项的字段："(field, fi) in group.fields"，由内向外匹配
+    for (int depth = 0; depth < enclosingItemVars.size(); ++depth) {
+        const QString& outerItemVar = enclosingItemVars.at(depth);
+        if (listName.startsWith(outerItemVar + ".") && listName.size() > outerItemVar.size() + 1) {
+            level->sourceField = listName.mid(outerItemVar.size() + 1);
+            level->sourceDepth = depth;
+            break;
+        }
+    }
+    if (!enclosingItemVars.isEmpty() && level->sourceField.isEmpty() && listName.contains(QLatin1Char('.'))) {
+        qWarning() << "[Quik] q-for list" << listName << "matches no enclosing loop variable, using it as a data source name";
     }
     
-    // 将元素转换为 XML 字符串作为模板
-    QString templateXml;
-    QTextStream stream(&templateXml);
-    element.save(stream, 0);
+    // 过滤、排序和分页：q-filter="$item.enabled==1" q-sort="$item.name desc" page-size="50" page="$page"
+    QuikContext::GeneralQForOptions& options = level->options;
+    options.filter = element.attribute("q-filter");
+    options.sort = element.attribute("q-sort");
+    options.pageSize = element.attribute("page-size").toInt();
+    options.pageVariable = element.attribute("page");
+    if (options.pageVariable.startsWith('$')) {
+        options.pageVariable.remove(0, 1);
+    }
     
-    // 移除 q-for 属性，避免递归
-    templateXml.replace(QRegularExpression("\\s*q-for\\s*=\\s*\"[^\"]*\""), "");
+    // 将元素（去掉 q-for 相关属性，避免递归）转换为 XML 字符串作为模板
+    QDomElement templateElement = element.cloneNode(true).toElement();
+    templateElement.removeAttribute("q-for");
+    templateElement.removeAttribute("q-filter");
+    templateElement.removeAttribute("q-sort");
+    templateElement.removeAttribute("page-size");
+    templateElement.removeAttribute("page");
+    
+    // 嵌套的 q-for 各自编译为一层，模板中只留下 <QForSlot index="k"/>，由本层的行实例化
+    QList<QDomElement> nestedElements;
+    collectNestedQFor(templateElement, nestedElements);
+    for (QDomElement nestedElement : nestedElements) {
+        std::shared_ptr<QForLevel> nested = compileQFor(nestedElement, nestedElement.attribute("q-for"),
+                                                        QStringList() << itemVar << enclosingItemVars);
+        QDomElement slot = templateElement.ownerDocument().createElement("QForSlot");
+        slot.setAttribute("index", level->nested.size());
+        nestedElement.parentNode().replaceChild(slot, nestedElement);
+        level->nested.append(nested);
+        // 只有取本层项字段的子层计入嵌套字段；取更外层字段的子层随那一层的行重建
+        if (nested && !nested->sourceField.isEmpty() && nested->sourceDepth == 0 &&
+            !options.nestedFields.contains(nested->sourceField)) {
+            options.nestedFields.append(nested->sourceField);
+        }
+    }
+    
+    // 只有文本、变量名和 visible/enabled 随项变化的模板可以复用行；带嵌套 q-for 的行不复用
+    int nextPath = 0;
+    level->rebindable = annotateRebindable(templateElement, itemVar, indexVar, nextPath) && level->nested.isEmpty();
+    if (!level->rebindable) {
+        qDebug() << "[Quik] q-for rows for" << listName << "will be re-rendered instead of rebound";
+    }
     
-    qDebug() << "[Quik] Processing general q-for:" << qForExpr;
-    qDebug() << "[Quik] Template:" << templateXml.left(100) << "...";
+    QTextStream stream(&level->templateXml);
+    templateElement.save(stream, 0);
+    stream.flush();
+    level->compiled = ExpressionParser::compileTemplate(level->templateXml);
+    
+    qDebug() << "[Quik] Compiled general q-for:" << qForExpr << "with" << level->nested.size() << "nested";
+    qDebug() << "[Quik] Template:" << level->templateXml.left(100) << "...";
+    return level;
+}
+
+void XMLUIBuilder::instantiateQFor(const std::shared_ptr<QForLevel>& level, QWidget* container,
+                                   const QVector<TemplateScope>& outerScopes) {
+    const QString& listName = level->loop.listName;
     
     // 创建一个占位容器用于放置动态生成的组件
     auto* placeholder = new QWidget(container);
@@ -679,23 +920,53 @@ void XMLUIBuilder::processGeneralQFor(const QDomElement& element, QWidget* conta
         parentLayout->addWidget(placeholder);
     }
     
-    // 捕获 this 和必要变量用于回调
-    QString capturedItemVar = itemVar;
-    QString capturedIndexVar = indexVar;
+    // 嵌套层的列表取自外层的当前项；q-filter 对外层循环变量的引用由上下文按外层作用域求值
+    QuikContext::GeneralQForOptions options = level->options;
+    if (!outerScopes.isEmpty()) {
+        if (!level->sourceField.isEmpty()) {
+            options.sourceField = level->sourceField;
+            options.sourceDepth = level->sourceDepth;
+            options.items = outerScopes.value(level->sourceDepth).item.value(level->sourceField).toList();
+        }
+        options.outerScopes = outerScopes;
+    }
+    
+    // 回调持有本层的编译结果和外层作用域，行的作用域为 本层项 + 外层作用域
+    auto scopesFor = [level, outerScopes](int idx, const QVariantMap& data) -> QVector<TemplateScope> {
+        TemplateScope scope;
+        scope.itemVar = level->loop.itemVar;
+        scope.item = data;
+        scope.indexVar = level->loop.indexVar;
+        scope.index = idx;
+        QVector<TemplateScope> scopes;
+        scopes.reserve(outerScopes.size() + 1);
+        scopes.append(scope);
+        scopes += outerScopes;
+        return scopes;
+    };
+    
+    if (level->rebindable) {
+        options.rebindCallback = [this, level, scopesFor](QWidget* row, const QString&, int idx, const QVariantMap& data) {
+            return rebindQForItem(row, *level, scopesFor(idx, data));
+        };
+    }
     
     // 注册通用 q-for 绑定
     m_context->registerGeneralQFor(
-        listName, itemVar, indexVar, placeholder, templateXml,
-        [this, capturedItemVar, capturedIndexVar](const QString& tpl, int idx, const QVariantMap& data) -> QWidget* {
-            return renderQForItem(tpl, idx, data, capturedItemVar, capturedIndexVar);
-        }
+        listName, level->loop.itemVar, level->loop.indexVar, placeholder, level->templateXml,
+        [this, level, scopesFor](const QString&, int idx, const QVariantMap& data) -> QWidget* {
+            return renderQForItem(level, scopesFor(idx, data));
+        },
+        options
     );
 }
 
-QWidget* XMLUIBuilder::renderQForItem(const QString& templateXml, int index, const QVariantMap& itemData,
-                                       const QString& itemVar, const QString& indexVar) {
-    // 替换模板中的变量
-    QString processedXml = replaceTemplateVars(templateXml, index, itemData, itemVar, indexVar);
+QWidget* XMLUIBuilder::renderQForItem(const std::shared_ptr<QForLevel>& level, const QVector<TemplateScope>& scopes) {
+    const int index = scopes.first().index;
+    QUIK_TRACE_SCOPE_DETAIL("q-for item", QString::number(index));
+    
+    // 替换模板中的变量（本层和外层）
+    QString processedXml = level->compiled.render(scopes);
     
     qDebug() << "[Quik] Rendering q-for item" << index << ":" << processedXml.left(200);
     
@@ -713,8 +984,14 @@ QWidget* XMLUIBuilder::renderQForItem(const QString& templateXml, int index, con
         return nullptr;
     }
     
-    // 使用现有的 buildElement 创建组件
+    // 使用现有的 buildElement 创建组件，其中的 QForSlot 按本行的作用域实例化嵌套层
+    std::shared_ptr<QForLevel> previousLevel = m_renderingLevel;
+    QVector<TemplateScope> previousScopes = m_renderingScopes;
+    m_renderingLevel = level;
+    m_renderingScopes = scopes;
     QWidget* widget = buildElement(element, nullptr);
+    m_renderingLevel = previousLevel;
+    m_renderingScopes = previousScopes;
     
     if (widget) {
         // 处理 visible 属性绑定
@@ -741,35 +1018,252 @@ QWidget* XMLUIBuilder::renderQForItem(const QString& templateXml, int index, con
     return widget;
 }
 
-QString XMLUIBuilder::replaceTemplateVars(const QString& str, int index, const QVariantMap& itemData,
-                                          const QString& itemVar, const QString& indexVar) const {
-    QString result = str;
+bool XMLUIBuilder::rebindQForItem(QWidget* row, const QForLevel& level, const QVector<TemplateScope>& scopes) {
+    const int index = scopes.first().index;
+    QUIK_TRACE_SCOPE_DETAIL("q-for rebind", QString::number(index));
     
-    // 替换索引变量 $idx 或 $index
-    if (!indexVar.isEmpty()) {
-        result.replace(QString("$%1").arg(indexVar), QString::number(index));
+    QString processedXml = level.compiled.render(scopes);
+    QDomDocument doc;
+    if (!doc.setContent(processedXml)) {
+        return false;
     }
     
-    // 替换 $item.xxx 格式的变量
-    for (auto it = itemData.begin(); it != itemData.end(); ++it) {
-        QString placeholder = QString("$%1.%2").arg(itemVar).arg(it.key());
-        result.replace(placeholder, it.value().toString());
+    // 新项的元素与行中的组件按 _qpath 编号对应
+    QHash<int, QDomElement> elements;
+    collectRebindPaths(doc.documentElement(), elements);
+    QHash<int, QWidget*> widgets;
+    QList<QWidget*> candidates = row->findChildren<QWidget*>();
+    candidates.prepend(row);
+    for (QWidget* widget : candidates) {
+        QVariant path = widget->property("_Quik_qpath");
+        if (path.isValid()) {
+            widgets.insert(path.toInt(), widget);
+        }
+    }
+    if (widgets.size() != elements.size()) {
+        return false;
     }
     
-    // 替换 var 属性中的动态部分，如 var="data.$idx.name" → var="data.0.name"
-    if (!indexVar.isEmpty()) {
-        QRegularExpression varPattern(QString("var\\s*=\\s*\"([^\"]*\\$%1[^\"]*)\"").arg(indexVar));
-        QRegularExpressionMatchIterator matches = varPattern.globalMatch(result);
-        while (matches.hasNext()) {
-            QRegularExpressionMatch match = matches.next();
-            QString original = match.captured(0);
-            QString varValue = match.captured(1);
-            QString newVarValue = varValue.replace(QString("$%1").arg(indexVar), QString::number(index));
-            result.replace(original, QString("var=\"%1\"").arg(newVarValue));
+    m_context->releaseWidget(row);
+    
+    for (auto it = elements.constBegin(); it != elements.constEnd(); ++it) {
+        const QDomElement& element = it.value();
+        QWidget* widget = widgets.value(it.key());
+        if (!widget) return false;
+        
+        // processChildren 创建的带标签行：标题和 visible/enabled 作用在行容器上
+        QWidget* parent = widget->parentWidget();
+        QWidget* labeledRow = widget != row && parent && parent->property("_Quik_labeledRow").toBool() ? parent : nullptr;
+        QWidget* bindTarget = labeledRow ? labeledRow : widget;
+        
+        // 文本（与各组件创建器的取值规则一致）
+        QString title = element.attribute("title");
+        QString text = element.attribute("text");
+        if (labeledRow) {
+            if (auto* label = labeledRow->findChild<QLabel*>(QString(), Qt::FindDirectChildrenOnly)) {
+                label->setText(title);
+            }
+        } else if (auto* groupBox = qobject_cast<QGroupBox*>(widget)) {
+            groupBox->setTitle(title);
+        } else if (auto* button = qobject_cast<QPushButton*>(widget)) {
+            button->setText(text.isEmpty() ? title : text);
+        } else if (auto* button = qobject_cast<QAbstractButton*>(widget)) {
+            button->setText(title.isEmpty() ? text : title);
+        } else if (auto* label = qobject_cast<QLabel*>(widget)) {
+            label->setText(title.isEmpty() ? text : title);
+        }
+        
+        if (element.hasAttribute("tooltip")) {
+            widget->setToolTip(element.attribute("tooltip"));
+        }
+        
+        // 变量：新变量还没有值时组件先恢复为默认值，注册时作为变量的初始值
+        QString var = element.attribute("var");
+        if (!var.isEmpty()) {
+            if (!m_context->getValue(var).isValid()) {
+                const WidgetAdapter* adapter = WidgetAdapterRegistry::instance().resolve(widget->metaObject());
+                QVariantMap defaults = WidgetFactory::defaultValues(element);
+                if (adapter && adapter->write && defaults.contains(var)) {
+                    adapter->write(widget, defaults.value(var));
+                }
+            }
+            widget->setObjectName(var);
+            if (widget->property("_Quik_varName").isValid()) {
+                widget->setProperty("_Quik_varName", var);
+            }
+            m_context->registerVariable(var, widget);
+        }
+        
+        // visible/enabled 绑定
+        QString visible = element.attribute("visible");
+        if (!visible.isEmpty()) {
+            if (ExpressionParser::isExpression(visible)) {
+                m_context->bindVisible(bindTarget, visible);
+            } else {
+                bindTarget->setVisible(visible == "true" || visible == "1");
+            }
+        }
+        QString enabled = element.attribute("enabled");
+        if (!enabled.isEmpty()) {
+            if (ExpressionParser::isExpression(enabled)) {
+                m_context->bindEnabled(bindTarget, enabled);
+            } else {
+                bindTarget->setEnabled(enabled == "true" || enabled == "1");
+            }
         }
     }
     
-    return result;
+    qDebug() << "[Quik] Rebound q-for row to item" << index;
+    return true;
+}
+
+// ========== 无界面模型 ==========
+
+void XMLUIBuilder::processModelChildren(const QDomElement& element, const QString& parentField) {
+    QDomElement child = element.firstChildElement();
+    for (; !child.isNull(); child = child.nextSiblingElement()) {
+        QString tagName = child.tagName();
+        
+        // 跳过Choice、Item（由父组件处理）和布局占位
+        if (tagName == "Choice" || tagName == "Item" || tagName == "addStretch") {
+            continue;
+        }
+        
+        if (tagName == "Computed") {
+            m_context->registerComputed(child.attribute("var"), child.attribute("expr"));
+            continue;
+        }
+        
+        QString qFor = child.attribute("q-for");
+        if (!qFor.isEmpty()) {
+            expandModelQFor(child, parentField, qFor);
+            continue;
+        }
+        
+        // 展开中的行里嵌套的 q-for：按本行的作用域展开原始元素
+        if (tagName == "QForSlot") {
+            const int index = child.attribute("index").toInt();
+            if (index >= 0 && index < m_modelSlots.size()) {
+                const QDomElement nested = m_modelSlots.at(index);
+                expandModelQFor(nested, parentField, nested.attribute("q-for"));
+            }
+            continue;
+        }
+        
+        processModelElement(child, parentField);
+    }
+}
+
+void XMLUIBuilder::processModelElement(const QDomElement& element, const QString& parentField) {
+    QString tagName = element.tagName();
+    bool container = isContainerTag(tagName);
+    
+    if (!container && !WidgetFactory::instance().hasCreator(tagName)) {
+        QString error = QString("Unknown tag: <%1>").arg(tagName);
+        qWarning() << "[Quik]" << error;
+        emit buildError(error);
+        return;
+    }
+    
+    QString visible = element.attribute("visible");
+    QString enabled = element.attribute("enabled");
+    
+    // 字段名取 var；没有 var 但有条件的容器生成一个名字，使其子字段能继承条件
+    QString field = element.attribute("var");
+    if (field.isEmpty() && container && (!visible.isEmpty() || !enabled.isEmpty())) {
+        field = QString("%1#%2").arg(tagName).arg(m_context->fields().size());
+    }
+    
+    if (!field.isEmpty()) {
+        m_context->registerField(field, parentField);
+        
+        QVariantMap defaults = WidgetFactory::defaultValues(element);
+        for (auto it = defaults.constBegin(); it != defaults.constEnd(); ++it) {
+            m_context->registerValue(it.key(), it.value());
+        }
+        
+        m_context->bindField(field, "visible", visible);
+        m_context->bindField(field, "enabled", enabled);
+        
+        ValidationRule rule = WidgetFactory::validationRule(element);
+        if (!rule.isEmpty()) {
+            m_context->setFieldValidation(field, rule);
+        }
+    }
+    
+    if (container) {
+        processModelChildren(element, field.isEmpty() ? parentField : field);
+    }
+}
+
+void XMLUIBuilder::expandModelQFor(const QDomElement& element, const QString& parentField, const QString& qForExpr) {
+    QForExpression qFor = ExpressionParser::parseQFor(qForExpr);
+    if (!qFor.isValid) {
+        qWarning() << "[Quik] Invalid q-for expression:" << qForExpr;
+        return;
+    }
+    
+    // 嵌套时列表可以是外层行的项的字段（"field in group.fields"），由内向外匹配
+    const QString& listName = qFor.listName;
+    QVariantList items;
+    bool fromOuter = false;
+    for (const TemplateScope& scope : m_modelScopes) {
+        if (listName.startsWith(scope.itemVar + ".") && listName.size() > scope.itemVar.size() + 1) {
+            items = scope.item.value(listName.mid(scope.itemVar.size() + 1)).toList();
+            fromOuter = true;
+            break;
+        }
+    }
+    if (!fromOuter) {
+        if (!m_modelScopes.isEmpty() && listName.contains(QLatin1Char('.'))) {
+            qWarning() << "[Quik] q-for list" << listName << "matches no enclosing loop variable, using it as a data source name";
+        }
+        items = m_context->getListData(listName);
+    }
+    
+    // 与界面相同，嵌套的 q-for 替换为 <QForSlot index="k"/>，由本层的每一行按各自的作用域展开
+    QDomElement templateElement = element.cloneNode(true).toElement();
+    templateElement.removeAttribute("q-for");
+    QList<QDomElement> nestedElements;
+    collectNestedQFor(templateElement, nestedElements);
+    for (int k = 0; k < nestedElements.size(); ++k) {
+        QDomElement slot = templateElement.ownerDocument().createElement("QForSlot");
+        slot.setAttribute("index", k);
+        nestedElements[k].parentNode().replaceChild(slot, nestedElements[k]);
+    }
+    QString templateXml;
+    QTextStream stream(&templateXml);
+    templateElement.save(stream, 0);
+    stream.flush();
+    const CompiledTemplate compiled = ExpressionParser::compileTemplate(templateXml);
+    
+    const QVector<TemplateScope> outerScopes = m_modelScopes;
+    const QList<QDomElement> outerSlots = m_modelSlots;
+    m_modelSlots = nestedElements;
+    for (int i = 0; i < items.size(); ++i) {
+        TemplateScope scope;
+        scope.itemVar = qFor.itemVar;
+        scope.item = items.at(i).toMap();
+        scope.indexVar = qFor.indexVar;
+        scope.index = i;
+        m_modelScopes = QVector<TemplateScope>() << scope << outerScopes;
+        
+        QDomDocument doc;
+        QString errorMsg;
+        if (!doc.setContent(compiled.render(m_modelScopes), &errorMsg)) {
+            qWarning() << "[Quik] Failed to parse q-for template:" << errorMsg;
+            continue;
+        }
+        processModelElement(doc.documentElement(), parentField);
+    }
+    m_modelScopes = outerScopes;
+    m_modelSlots = outerSlots;
+}
+
+QString XMLUIBuilder::replaceTemplateVars(const QString& str, int index, const QVariantMap& itemData,
+                                          const QString& itemVar, const QString& indexVar) const {
+    // 单遍替换 $idx、$item.xxx，包括 var 属性中的动态部分，如 var="data.$idx.name" → var="data.0.name"
+    return ExpressionParser::substituteTemplate(str, itemVar, itemData, indexVar, index);
 }
 
 void XMLUIBuilder::showErrorOverlay(const QString& errorMsg, int line, int column) {
@@ -12,6 +12,7 @@
 #include <QFileSystemWatcher>
 #include <QJsonObject>
 #include <functional>
+#include <memory>
 
 namespace Quik {
 
@@ -42,6 +43,40 @@ public:
      */
     QWidget* buildFromString(const QString& xmlContent, QWidget* parent = nullptr);
     
+    /**
+     * @brief 从XML文件构建无界面模型
+     * @param filePath XML文件路径
+     * @return 是否成功
+     * @see buildModel
+     */
+    bool buildModelFromFile(const QString& filePath);
+    
+    /**
+     * @brief 从XML字符串构建无界面模型（不创建任何 QWidget）
+     * @param xmlContent XML内容字符串
+     * @return 是否成功
+     * 
+     * 上下文中只有变量（含默认值和计算变量）、按字段编译的 visible/enabled 绑定和校验规则，
+     * 用于批量工具和服务端校验：加载参数后通过 QuikContext::isFieldActive() 和
+     * QuikContext::validationErrors() 得到与界面一致的结果。不需要 QApplication，
+     * 每个线程使用各自的构建器即可并行处理多个参数文件。
+     * 
+     * q-for 在构建时按当前数据源展开一次，因此数据源须在构建前通过 setListData 设置。
+     * 
+     * 使用示例：
+     * @code
+     * QtConcurrent::blockingMap(jsonFiles, [&](const QString& jsonFile) {
+     *     XMLUIBuilder builder;
+     *     builder.buildModel(xml);
+     *     builder.loadFromJson(jsonFile);
+     *     if (!builder.isValid()) {
+     *         qWarning() << jsonFile << builder.getValidationErrors();
+     *     }
+     * });
+     * @endcode
+     */
+    bool buildModel(const QString& xmlContent);
+    
     /**
      * @brief 获取响应式上下文
      * @return 上下文指针
@@ -69,6 +104,14 @@ public:
      */
     void setValue(const QString& varName, const QVariant& value);
     
+    /**
+     * @brief 从任意线程投递变量值（线程安全）
+     * @param varName 变量名
+     * @param value 变量值
+     * @see QuikContext::postValue
+     */
+    void postValue(const QString& varName, const QVariant& value);
+    
     /**
      * @brief 连接按钮点击信号
      * @param varName 按钮变量名
@@ -123,6 +166,31 @@ public:
      * modes << QVariantMap{{"text", "模式二"}, {"val", "mode2"}};
      * builder.setListData("modes", modes);
      * @endcode
+     * 
+     * 通用 q-for 可以用 q-filter 过滤、q-sort 排序，过滤表达式可以引用上下文变量：
+     * @code
+     * // <LineEdit q-for="(item, idx) in params" q-filter="$item.enabled==1 or $showAll==1"
+     * //           q-sort="$item.name" title="$item.name" var="params.$idx.value"/>
+     * @endcode
+     * 数据源或 $showAll 变化时只渲染进入视图的行、销毁离开的行，其余行原样保留或移动；
+     * 模板中的 $idx 是项在数据源中的位置。
+     * 
+     * 长列表可以分页，只创建当前页的行，翻页时复用已有的行：
+     * @code
+     * // <LineEdit q-for="(item, idx) in results" page-size="50" page="$page"
+     * //           title="$item.name" var="results.$idx.value"/>
+     * @endcode
+     * $page 从 0 开始。模板中只有文本、变量名和 visible/enabled 随项变化时，行组件改绑到新项，
+     * 否则离开的行被销毁、进入的行重新渲染。
+     * 
+     * q-for 可以嵌套，内层可以遍历外层项的字段，也可以引用外层的循环变量：
+     * @code
+     * // <GroupBox q-for="(group, gi) in groups" title="$group.name">
+     * //     <LineEdit q-for="(field, fi) in group.fields" title="$field.label"
+     * //               var="groups.$gi.$fi"/>
+     * // </GroupBox>
+     * @endcode
+     * 每层单独编译；外层项只有 fields 变化时只重新渲染这一组的内层，外层行保留。
      */
     void setListData(const QString& name, const QVariantList& items);
     
@@ -225,9 +293,26 @@ public:
     /**
      * @brief 获取所有验证错误
      * @return 变量名到错误信息的映射
+     * 
+     * 无界面模型中按当前值校验，只包含生效（可见且可用）的字段。
      */
     QMap<QString, QString> getValidationErrors() const;
     
+    // ========== 统计 ==========
+    
+    /**
+     * @brief 获取内存占用统计
+     * 
+     * 在 QuikContext::memoryStats() 的基础上统计整棵组件树（含标签、行容器等），
+     * 并计入构建器自己保存的数据源副本（与上下文共享的部分不重复计算）。
+     * 
+     * 使用示例：
+     * @code
+     * qDebug().noquote() << builder.memoryStats().toString();
+     * @endcode
+     */
+    MemoryStats memoryStats() const;
+    
 signals:
     /**
      * @brief UI构建完成信号
@@ -287,25 +372,83 @@ private:
      */
     bool isLayoutTag(const QString& tagName) const;
     
+    /**
+     * @brief 编译后的一层 q-for
+     * 
+     * 每层只编译一次：嵌套的 q-for 编译为子层，模板中只留下 <QForSlot index="k"/>，
+     * 外层每渲染一行时用该行的作用域实例化子层，不再把内层模板随外层文本重新序列化和解析。
+     */
+    struct QForLevel {
+        QForExpression loop;                    // 循环变量和数据源
+        QString sourceField;                    // 列表来自外层项的字段时的字段名，否则使用数据源
+        int sourceDepth = 0;                    // 列表所在的外层（0 为直接外层，1 为外层的外层……）
+        QString templateXml;                    // 模板（嵌套的 q-for 已替换为 QForSlot）
+        CompiledTemplate compiled;              // 预先切分的模板
+        QuikContext::GeneralQForOptions options;    // 过滤、排序、分页和嵌套列表字段（不含回调）
+        bool rebindable = false;                // 行能否改绑到其他项
+        QList<std::shared_ptr<QForLevel>> nested;   // 按 QForSlot 的 index 排列的子层
+    };
+    
     /**
      * @brief 处理通用 q-for 指令
      * @param element 带 q-for 属性的元素
      * @param container 父容器
      * @param qForExpr q-for 表达式，如 "item in items" 或 "(item, idx) in items"
+     * 
+     * 同时读取元素上的 q-filter、q-sort、page-size 和 page，它们不进入模板。
      */
     void processGeneralQFor(const QDomElement& element, QWidget* container, const QString& qForExpr);
     
+    /**
+     * @brief 编译一层 q-for（递归编译嵌套的 q-for）
+     * @param enclosingItemVars 外层的循环变量名（内层在前），列表写作 "外层变量.字段" 时取该层项的字段，顶层为空
+     * @return 编译结果，表达式无效时为空
+     */
+    std::shared_ptr<QForLevel> compileQFor(const QDomElement& element, const QString& qForExpr,
+                                           const QStringList& enclosingItemVars);
+    
+    /**
+     * @brief 在容器中实例化一层 q-for 并注册到上下文
+     * @param outerScopes 外层行的作用域（内层在前），顶层为空
+     */
+    void instantiateQFor(const std::shared_ptr<QForLevel>& level, QWidget* container,
+                         const QVector<TemplateScope>& outerScopes);
+    
     /**
      * @brief 根据模板和数据渲染单个组件
-     * @param templateXml 模板 XML 字符串
-     * @param index 当前索引
-     * @param itemData 当前项数据
-     * @param itemVar 循环变量名
-     * @param indexVar 索引变量名
+     * @param level 所在的 q-for 层
+     * @param scopes 本行的作用域：本层项在前，之后是外层
      * @return 渲染的组件
      */
-    QWidget* renderQForItem(const QString& templateXml, int index, const QVariantMap& itemData,
-                            const QString& itemVar, const QString& indexVar);
+    QWidget* renderQForItem(const std::shared_ptr<QForLevel>& level, const QVector<TemplateScope>& scopes);
+    
+    /**
+     * @brief 把已渲染的 q-for 行改绑到另一项（分页、过滤时复用组件）
+     * @param row renderQForItem 创建的行
+     * @return 是否成功，失败时行保持原状，由调用方销毁并重新渲染
+     * 
+     * 只更新模板中带 _qpath 编号的元素：文本、提示、变量名和 visible/enabled 绑定。
+     */
+    bool rebindQForItem(QWidget* row, const QForLevel& level, const QVector<TemplateScope>& scopes);
+    
+    /**
+     * @brief 无界面模型：处理容器的子元素
+     * @param element XML元素
+     * @param parentField 所在容器的字段名
+     */
+    void processModelChildren(const QDomElement& element, const QString& parentField);
+    
+    /**
+     * @brief 无界面模型：注册单个元素的字段、默认值、绑定和校验规则
+     */
+    void processModelElement(const QDomElement& element, const QString& parentField);
+    
+    /**
+     * @brief 无界面模型：按当前数据源展开 q-for
+     * 
+     * 嵌套的 q-for 由外层的每一行展开，列表可以是外层项的字段，模板中可引用外层的循环变量。
+     */
+    void expandModelQFor(const QDomElement& element, const QString& parentField, const QString& qForExpr);
     
     /**
      * @brief 替换字符串中的模板变量
@@ -323,11 +466,20 @@ private:
     QuikContext* m_context;
     QWidget* m_rootWidget = nullptr;
     
+    // 正在渲染的 q-for 行（processChildren 遇到 QForSlot 时用来实例化嵌套层）
+    std::shared_ptr<QForLevel> m_renderingLevel;
+    QVector<TemplateScope> m_renderingScopes;
+    
+    // 无界面模型中正在展开的 q-for 行：作用域（内层在前）和行模板中 QForSlot 对应的原始元素
+    QVector<TemplateScope> m_modelScopes;
+    QList<QDomElement> m_modelSlots;
+    
     // 热更新相关
     QFileSystemWatcher* m_watcher = nullptr;
     QString m_currentFilePath;
     QMap<QString, std::function<void()>> m_buttonCallbacks;
     QMap<QString, std::function<void(const QVariant&)>> m_watchCallbacks;
+    QMap<QString, WatchSite> m_watchSites;  // 监听的注册位置，热更新重新注册时恢复
     
     // 错误覆盖层
     QWidget* m_errorOverlay = nullptr;
@@ -0,0 +1,103 @@
+#include "ProfileOverlay.h"
+#include "core/QuikContext.h"
+#include <QPainter>
+#include <QTimer>
+#include <QEvent>
+#include <QHash>
+#include <algorithm>
+
+namespace Quik {
+
+ProfileOverlay::ProfileOverlay(QuikContext* context, QWidget* target)
+    : QWidget(target)
+    , m_context(context)
+    , m_target(target)
+    , m_timer(new QTimer(this))
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_NoSystemBackground);
+    setGeometry(target->rect());
+    target->installEventFilter(this);
+    
+    if (m_context) {
+        m_context->setProfilingEnabled(true);
+    }
+    
+    connect(m_timer, &QTimer::timeout, this, &ProfileOverlay::refresh);
+    m_timer->start(500);
+    
+    raise();
+    show();
+}
+
+void ProfileOverlay::setRefreshInterval(int msec) {
+    m_timer->start(msec);
+}
+
+void ProfileOverlay::refresh() {
+    m_hotspots.clear();
+    if (!m_context) {
+        update();
+        return;
+    }
+    
+    // 同一组件的多个绑定（visible + enabled）合并计数
+    QHash<QWidget*, quint64> counts;
+    const ProfileReport report = m_context->profile();
+    for (const ProfileEntry& entry : report.entries) {
+        if (entry.kind == ProfileEntry::Binding && entry.widget && entry.evaluations > 0) {
+            counts[entry.widget.data()] += entry.evaluations;
+        }
+    }
+    
+    for (auto it = counts.constBegin(); it != counts.constEnd(); ++it) {
+        Hotspot hotspot;
+        hotspot.widget = it.key();
+        hotspot.evaluations = it.value();
+        m_hotspots.append(hotspot);
+    }
+    std::sort(m_hotspots.begin(), m_hotspots.end(), [](const Hotspot& a, const Hotspot& b) {
+        return a.evaluations > b.evaluations;
+    });
+    if (m_hotspots.size() > m_maxHighlights) {
+        m_hotspots.resize(m_maxHighlights);
+    }
+    
+    raise();
+    update();
+}
+
+void ProfileOverlay::paintEvent(QPaintEvent* event) {
+    Q_UNUSED(event)
+    if (m_hotspots.isEmpty()) return;
+    
+    QPainter painter(this);
+    const quint64 hottest = m_hotspots.first().evaluations;
+    
+    for (const Hotspot& hotspot : m_hotspots) {
+        QWidget* widget = hotspot.widget;
+        if (!widget || !widget->isVisibleTo(m_target)) continue;
+        
+        // 越热越红越不透明
+        double heat = double(hotspot.evaluations) / hottest;
+        QColor color(255, int(200 * (1.0 - heat)), 0);
+        QRect rect(widget->mapTo(m_target, QPoint(0, 0)), widget->size());
+        
+        color.setAlpha(40 + int(60 * heat));
+        painter.fillRect(rect, color);
+        color.setAlpha(220);
+        painter.setPen(QPen(color, 2));
+        painter.drawRect(rect.adjusted(1, 1, -1, -1));
+        painter.drawText(rect.adjusted(4, 2, -4, -2), Qt::AlignRight | Qt::AlignTop,
+                         QString::number(hotspot.evaluations));
+    }
+}
+
+bool ProfileOverlay::eventFilter(QObject* watched, QEvent* event) {
+    if (watched == m_target && event->type() == QEvent::Resize) {
+        setGeometry(m_target->rect());
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+} // namespace Quik
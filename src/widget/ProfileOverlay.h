@@ -0,0 +1,74 @@
+#ifndef PROFILEOVERLAY_H
+#define PROFILEOVERLAY_H
+
+#include "Quik/QuikAPI.h"
+#include <QWidget>
+#include <QPointer>
+#include <QVector>
+
+class QTimer;
+
+namespace Quik {
+
+class QuikContext;
+
+/**
+ * @brief 绑定热点调试浮层
+ *
+ * 覆盖在目标组件上方（不拦截鼠标），定时读取 QuikContext::profile()，
+ * 用颜色深浅标出绑定求值次数最多的组件并显示次数。会自动开启上下文的性能计数。
+ *
+ * 使用示例：
+ * @code
+ * QWidget* ui = Quik_BUILD(builder, "Panel.xml");
+ * auto* overlay = new Quik::ProfileOverlay(builder.context(), ui);
+ * overlay->setMaxHighlights(5);
+ * @endcode
+ */
+class QUIK_API ProfileOverlay : public QWidget {
+    Q_OBJECT
+    
+public:
+    /**
+     * @brief 构造函数
+     * @param context 要分析的上下文
+     * @param target 覆盖的组件（浮层作为其子组件，随其大小变化）
+     */
+    ProfileOverlay(QuikContext* context, QWidget* target);
+    
+    /**
+     * @brief 设置最多标出的组件数（默认10）
+     */
+    void setMaxHighlights(int count) { m_maxHighlights = count; }
+    
+    /**
+     * @brief 设置刷新间隔（默认500毫秒）
+     */
+    void setRefreshInterval(int msec);
+    
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    bool eventFilter(QObject* watched, QEvent* event) override;
+    
+private slots:
+    /**
+     * @brief 重新读取性能报告并重绘
+     */
+    void refresh();
+    
+private:
+    struct Hotspot {
+        QPointer<QWidget> widget;
+        quint64 evaluations;
+    };
+    
+    QPointer<QuikContext> m_context;
+    QWidget* m_target;
+    QTimer* m_timer;
+    QVector<Hotspot> m_hotspots;        // 按求值次数降序
+    int m_maxHighlights = 10;
+};
+
+} // namespace Quik
+
+#endif // PROFILEOVERLAY_H
@@ -0,0 +1,233 @@
+#include "WidgetAdapter.h"
+#include <QCheckBox>
+#include <QRadioButton>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QAbstractSlider>
+#include <QProgressBar>
+#include <QLabel>
+#include <QTabBar>
+#include <QDateTimeEdit>
+#include <QTextEdit>
+#include <QPlainTextEdit>
+#include <QListWidget>
+#include <QDebug>
+
+namespace Quik {
+
+WidgetAdapterRegistry& WidgetAdapterRegistry::instance() {
+    static WidgetAdapterRegistry instance;
+    return instance;
+}
+
+WidgetAdapterRegistry::WidgetAdapterRegistry() {
+    registerBuiltinAdapters();
+}
+
+WidgetAdapterRegistry::~WidgetAdapterRegistry() {
+    qDeleteAll(m_adapters);
+}
+
+void WidgetAdapterRegistry::registerAdapter(const QMetaObject* metaObject, const WidgetAdapter& adapter) {
+    if (!metaObject) return;
+
+    // 覆盖时原地赋值，保证已解析的指针仍然有效
+    if (WidgetAdapter* existing = m_adapters.value(metaObject)) {
+        *existing = adapter;
+    } else {
+        m_adapters.insert(metaObject, new WidgetAdapter(adapter));
+    }
+
+    // 新注册可能改变继承链查找结果
+    m_resolved.clear();
+}
+
+const WidgetAdapter* WidgetAdapterRegistry::resolve(const QMetaObject* metaObject) const {
+    if (!metaObject) return nullptr;
+
+    auto cached = m_resolved.constFind(metaObject);
+    if (cached != m_resolved.constEnd()) {
+        return cached.value();
+    }
+
+    // 沿继承链向上查找最近的适配器
+    const WidgetAdapter* adapter = nullptr;
+    for (const QMetaObject* mo = metaObject; mo && !adapter; mo = mo->superClass()) {
+        adapter = m_adapters.value(mo);
+    }
+
+    m_resolved.insert(metaObject, adapter);
+    return adapter;
+}
+
+void WidgetAdapterRegistry::registerBuiltinAdapters() {
+    if (m_initialized) return;
+
+    // QCheckBox / QRadioButton - 值为 1/0
+    registerAdapter<QCheckBox>(
+        [](QCheckBox* w) -> QVariant { return w->isChecked() ? 1 : 0; },
+        [](QCheckBox* w, const QVariant& v) { w->setChecked(v.toInt() != 0); },
+        &QCheckBox::toggled);
+
+    registerAdapter<QRadioButton>(
+        [](QRadioButton* w) -> QVariant { return w->isChecked() ? 1 : 0; },
+        [](QRadioButton* w, const QVariant& v) { w->setChecked(v.toInt() != 0); },
+        &QRadioButton::toggled);
+
+    // QComboBox - 使用itemData作为值，没有则用text
+    registerAdapter<QComboBox>(
+        [](QComboBox* w) -> QVariant {
+            QVariant data = w->currentData();
+            return data.isValid() ? data : QVariant(w->currentText());
+        },
+        [](QComboBox* w, const QVariant& v) {
+            QString valStr = v.toString();
+            for (int i = 0; i < w->count(); ++i) {
+                QVariant data = w->itemData(i);
+                if ((data.isValid() && data.toString() == valStr) || w->itemText(i) == valStr) {
+                    w->setCurrentIndex(i);
+                    break;
+                }
+            }
+        },
+        QOverload<int>::of(&QComboBox::currentIndexChanged));
+
+    // QLineEdit
+    registerAdapter<QLineEdit>(
+        [](QLineEdit* w) -> QVariant { return w->text(); },
+        [](QLineEdit* w, const QVariant& v) { w->setText(v.toString()); },
+        &QLineEdit::textChanged);
+
+    // QSpinBox
+    registerAdapter<QSpinBox>(
+        [](QSpinBox* w) -> QVariant { return w->value(); },
+        [](QSpinBox* w, const QVariant& v) { w->setValue(v.toInt()); },
+        QOverload<int>::of(&QSpinBox::valueChanged));
+
+    // QDoubleSpinBox
+    registerAdapter<QDoubleSpinBox>(
+        [](QDoubleSpinBox* w) -> QVariant { return w->value(); },
+        [](QDoubleSpinBox* w, const QVariant& v) { w->setValue(v.toDouble()); },
+        QOverload<double>::of(&QDoubleSpinBox::valueChanged));
+
+    // QSlider / QDial（共同基类 QAbstractSlider）
+    registerAdapter<QAbstractSlider>(
+        [](QAbstractSlider* w) -> QVariant { return w->value(); },
+        [](QAbstractSlider* w, const QVariant& v) { w->setValue(v.toInt()); },
+        &QAbstractSlider::valueChanged);
+
+    // QProgressBar - 只读显示
+    registerAdapter<QProgressBar>(
+        [](QProgressBar* w) -> QVariant { return w->value(); },
+        [](QProgressBar* w, const QVariant& v) { w->setValue(v.toInt()); });
+
+    // QLabel - 只读显示，用于LabelList中的Item
+    registerAdapter<QLabel>(
+        [](QLabel* w) -> QVariant { return w->text(); },
+        [](QLabel* w, const QVariant& v) { w->setText(v.toString()); });
+
+    // QTabBar - 使用tabData作为值，没有则用标签文本
+    registerAdapter<QTabBar>(
+        [](QTabBar* w) -> QVariant {
+            int index = w->currentIndex();
+            if (index < 0) return QVariant();
+            QVariant data = w->tabData(index);
+            return data.isValid() ? QVariant(data.toString()) : QVariant(w->tabText(index));
+        },
+        [](QTabBar* w, const QVariant& v) {
+            QString valStr = v.toString();
+            for (int i = 0; i < w->count(); ++i) {
+                QVariant data = w->tabData(i);
+                if ((data.isValid() && data.toString() == valStr) || w->tabText(i) == valStr) {
+                    w->setCurrentIndex(i);
+                    break;
+                }
+            }
+        },
+        &QTabBar::currentChanged);
+
+    // QDateTimeEdit - 以ISO字符串存储，便于表达式比较和JSON持久化
+    registerAdapter<QDateTimeEdit>(
+        [](QDateTimeEdit* w) -> QVariant { return w->dateTime().toString(Qt::ISODate); },
+        [](QDateTimeEdit* w, const QVariant& v) {
+            QDateTime dt = v.type() == QVariant::DateTime
+                ? v.toDateTime()
+                : QDateTime::fromString(v.toString(), Qt::ISODate);
+            if (!dt.isValid()) {
+                dt = QDateTime::fromString(v.toString(), w->displayFormat());
+            }
+            if (dt.isValid()) {
+                w->setDateTime(dt);
+            }
+        },
+        &QDateTimeEdit::dateTimeChanged);
+
+    // QTextEdit / QPlainTextEdit - 纯文本，内容相同时不重设（避免光标复位）
+    registerAdapter<QTextEdit>(
+        [](QTextEdit* w) -> QVariant { return w->toPlainText(); },
+        [](QTextEdit* w, const QVariant& v) {
+            QString text = v.toString();
+            if (w->toPlainText() != text) w->setPlainText(text);
+        },
+        &QTextEdit::textChanged);
+
+    registerAdapter<QPlainTextEdit>(
+        [](QPlainTextEdit* w) -> QVariant { return w->toPlainText(); },
+        [](QPlainTextEdit* w, const QVariant& v) {
+            QString text = v.toString();
+            if (w->toPlainText() != text) w->setPlainText(text);
+        },
+        &QPlainTextEdit::textChanged);
+
+    // QListWidget - 单选为当前项文本，多选为选中项文本列表
+    registerAdapter<QListWidget>(
+        [](QListWidget* w) -> QVariant {
+            if (w->selectionMode() == QAbstractItemView::SingleSelection) {
+                QListWidgetItem* item = w->currentItem();
+                return item ? item->text() : QString();
+            }
+            QStringList texts;
+            for (QListWidgetItem* item : w->selectedItems()) {
+                texts << item->text();
+            }
+            return texts;
+        },
+        [](QListWidget* w, const QVariant& v) {
+            QStringList texts = v.type() == QVariant::StringList || v.type() == QVariant::List
+                ? v.toStringList()
+                : QStringList(v.toString());
+            for (int i = 0; i < w->count(); ++i) {
+                QListWidgetItem* item = w->item(i);
+                bool selected = texts.contains(item->text());
+                item->setSelected(selected);
+                if (selected && w->selectionMode() == QAbstractItemView::SingleSelection) {
+                    w->setCurrentItem(item);
+                }
+            }
+        },
+        &QListWidget::itemSelectionChanged);
+
+    // 提交信号：用于 commit="editingFinished"，输入过程中不写入上下文
+    registerCommitSignal<QLineEdit>(&QLineEdit::editingFinished);
+    registerCommitSignal<QSpinBox>(&QSpinBox::editingFinished);
+    registerCommitSignal<QDoubleSpinBox>(&QDoubleSpinBox::editingFinished);
+    registerCommitSignal<QDateTimeEdit>(&QDateTimeEdit::editingFinished);
+    
+    // 滑块：拖动中不提交，松开时提交；键盘、滚轮和点击滑轨不经过拖动，值变化即提交
+    if (WidgetAdapter* slider = m_adapters.value(&QAbstractSlider::staticMetaObject)) {
+        slider->connectCommitted = [](QWidget* w, QObject* receiver, std::function<void()> handler) -> QMetaObject::Connection {
+            auto* s = static_cast<QAbstractSlider*>(w);
+            QObject::connect(s, &QAbstractSlider::valueChanged, receiver, [s, handler](int) {
+                if (!s->isSliderDown()) handler();
+            });
+            return QObject::connect(s, &QAbstractSlider::sliderReleased, receiver, handler);
+        };
+    }
+    
+    m_initialized = true;
+    qDebug() << "[Quik] Registered" << m_adapters.size() << "builtin widget adapters";
+}
+
+} // namespace Quik
@@ -0,0 +1,166 @@
+#ifndef WIDGETADAPTER_H
+#define WIDGETADAPTER_H
+
+#include "Quik/QuikAPI.h"
+#include <QWidget>
+#include <QVariant>
+#include <QHash>
+#include <functional>
+
+namespace Quik {
+
+/**
+ * @brief 组件值适配器
+ *
+ * 描述一种组件类型如何读取值、写入值以及连接值变化信号。
+ * 在 QuikContext::registerVariable 时按组件的 QMetaObject 解析一次并随变量保存，
+ * 之后的同步只需一次间接调用，不再逐个尝试 qobject_cast。
+ */
+struct QUIK_API WidgetAdapter {
+    using Reader = std::function<QVariant(QWidget*)>;
+    using Writer = std::function<void(QWidget*, const QVariant&)>;
+    using ChangeHandler = std::function<void(const QVariant&)>;
+    using Connector = std::function<QMetaObject::Connection(QWidget*, QObject*, ChangeHandler)>;
+    using CommitConnector = std::function<QMetaObject::Connection(QWidget*, QObject*, std::function<void()>)>;
+
+    Reader read;                        // 读取组件当前值
+    Writer write;                       // 写入值到组件（调用方负责阻止信号）
+    Connector connectChanged;           // 连接值变化信号，只读组件可为空
+    CommitConnector connectCommitted;   // 连接"提交"信号（commit="editingFinished"），可为空
+};
+
+/**
+ * @brief 组件适配器注册表
+ *
+ * 按 QMetaObject 注册适配器，解析时沿继承链向上查找，
+ * 因此自定义组件只要继承自内置组件即可复用其适配器。
+ *
+ * 使用示例：
+ * @code
+ * WidgetAdapterRegistry::instance().registerAdapter<MyColorPicker>(
+ *     [](MyColorPicker* w) -> QVariant { return w->color(); },
+ *     [](MyColorPicker* w, const QVariant& v) { w->setColor(v.value<QColor>()); },
+ *     &MyColorPicker::colorChanged);
+ * @endcode
+ */
+class QUIK_API WidgetAdapterRegistry {
+public:
+    /**
+     * @brief 获取单例实例
+     */
+    static WidgetAdapterRegistry& instance();
+
+    /**
+     * @brief 注册适配器（同一类型重复注册时覆盖）
+     * @param metaObject 组件类型的元对象
+     * @param adapter 适配器
+     */
+    void registerAdapter(const QMetaObject* metaObject, const WidgetAdapter& adapter);
+
+    /**
+     * @brief 以类型安全的方式注册无变化信号的适配器（只读显示组件）
+     * @tparam W 组件类型
+     * @param reader 读取函数
+     * @param writer 写入函数
+     */
+    template<typename W>
+    void registerAdapter(std::function<QVariant(W*)> reader,
+                         std::function<void(W*, const QVariant&)> writer);
+
+    /**
+     * @brief 以类型安全的方式注册适配器
+     * @tparam W 组件类型
+     * @param reader 读取函数
+     * @param writer 写入函数
+     * @param signal 值变化信号（可以是基类信号，如 &QCheckBox::toggled）
+     */
+    template<typename W, typename S, typename... Args>
+    void registerAdapter(std::function<QVariant(W*)> reader,
+                         std::function<void(W*, const QVariant&)> writer,
+                         void (S::*signal)(Args...));
+
+    /**
+     * @brief 为已注册的适配器设置"提交"信号
+     * @tparam W 组件类型（须已注册适配器）
+     * @param signal 提交信号，如 &QLineEdit::editingFinished、&QSpinBox::editingFinished
+     * 
+     * 组件设置 commit="editingFinished" 时，上下文只在该信号触发时读取并写入值。
+     */
+    template<typename W, typename S, typename... Args>
+    void registerCommitSignal(void (S::*signal)(Args...));
+
+    /**
+     * @brief 解析组件类型对应的适配器（结果按类型缓存）
+     * @param metaObject 组件类型的元对象
+     * @return 适配器指针，未找到返回nullptr
+     */
+    const WidgetAdapter* resolve(const QMetaObject* metaObject) const;
+
+    /**
+     * @brief 注册所有内置组件适配器
+     */
+    void registerBuiltinAdapters();
+
+private:
+    WidgetAdapterRegistry();
+    ~WidgetAdapterRegistry();
+
+    // 禁止拷贝
+    WidgetAdapterRegistry(const WidgetAdapterRegistry&) = delete;
+    WidgetAdapterRegistry& operator=(const WidgetAdapterRegistry&) = delete;
+
+    QHash<const QMetaObject*, WidgetAdapter*> m_adapters;                 // 注册的适配器（拥有所有权）
+    mutable QHash<const QMetaObject*, const WidgetAdapter*> m_resolved;   // 解析缓存（含继承链查找结果）
+    bool m_initialized = false;
+};
+
+template<typename W>
+void WidgetAdapterRegistry::registerAdapter(std::function<QVariant(W*)> reader,
+                                            std::function<void(W*, const QVariant&)> writer) {
+    WidgetAdapter adapter;
+    if (reader) {
+        adapter.read = [reader](QWidget* w) { return reader(static_cast<W*>(w)); };
+    }
+    if (writer) {
+        adapter.write = [writer](QWidget* w, const QVariant& v) { writer(static_cast<W*>(w), v); };
+    }
+    registerAdapter(&W::staticMetaObject, adapter);
+}
+
+template<typename W, typename S, typename... Args>
+void WidgetAdapterRegistry::registerAdapter(std::function<QVariant(W*)> reader,
+                                            std::function<void(W*, const QVariant&)> writer,
+                                            void (S::*signal)(Args...)) {
+    WidgetAdapter adapter;
+    if (reader) {
+        adapter.read = [reader](QWidget* w) { return reader(static_cast<W*>(w)); };
+    }
+    if (writer) {
+        adapter.write = [writer](QWidget* w, const QVariant& v) { writer(static_cast<W*>(w), v); };
+    }
+    if (reader && signal) {
+        adapter.connectChanged = [reader, signal](QWidget* w, QObject* receiver, WidgetAdapter::ChangeHandler handler) {
+            W* widget = static_cast<W*>(w);
+            return QObject::connect(widget, signal, receiver, [widget, reader, handler](Args...) {
+                handler(reader(widget));
+            });
+        };
+    }
+    registerAdapter(&W::staticMetaObject, adapter);
+}
+
+template<typename W, typename S, typename... Args>
+void WidgetAdapterRegistry::registerCommitSignal(void (S::*signal)(Args...)) {
+    WidgetAdapter* adapter = m_adapters.value(&W::staticMetaObject);
+    if (!adapter || !signal) return;
+
+    adapter->connectCommitted = [signal](QWidget* w, QObject* receiver, std::function<void()> handler) {
+        return QObject::connect(static_cast<W*>(w), signal, receiver, [handler](Args...) {
+            handler();
+        });
+    };
+}
+
+} // namespace Quik
+
+#endif // WIDGETADAPTER_H
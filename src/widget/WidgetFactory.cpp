@@ -1,5 +1,6 @@
 #include "WidgetFactory.h"
 #include "core/QuikContext.h"
+#include "core/QuikTrace.h"
 #include <QLabel>
 #include <QLineEdit>
 #include <QCheckBox>
@@ -28,16 +29,6 @@
 
 namespace Quik {
 
-// 验证错误提示文本（集中管理，便于国际化）
-// 注意：如需中文，请确保源文件保存为UTF-8 with BOM编码
-namespace ValidationMessages {
-    static QString required()         { return QStringLiteral("Required"); }
-    static QString minValue(double v) { return QString("Min: %1").arg(v); }
-    static QString maxValue(double v) { return QString("Max: %1").arg(v); }
-    static QString invalidFormat()    { return QStringLiteral("Invalid"); }
-    static QString invalidNumber()    { return QStringLiteral("Invalid number"); }
-}
-
 WidgetFactory& WidgetFactory::instance() {
     static WidgetFactory instance;
     return instance;
@@ -51,7 +42,15 @@ void WidgetFactory::registerCreator(const QString& tagName, WidgetCreator creato
     m_creators[tagName] = creator;
 }
 
+void WidgetFactory::registerCreator(const QString& tagName, WidgetCreator creator,
+                                    const QMetaObject* metaObject, const WidgetAdapter& adapter) {
+    registerCreator(tagName, creator);
+    WidgetAdapterRegistry::instance().registerAdapter(metaObject, adapter);
+}
+
 QWidget* WidgetFactory::create(const QString& tagName, const QDomElement& element, QuikContext* context) {
+    QUIK_TRACE_SCOPE_DETAIL("create", tagName);
+    
     if (!m_creators.contains(tagName)) {
         qWarning() << "[Quik] Unknown widget tag:" << tagName;
         return nullptr;
@@ -143,25 +142,18 @@ QWidget* WidgetFactory::createLineEdit(const QDomElement& element, QuikContext*
     bool readOnly = getBoolAttribute(element, "readOnly", false);
     lineEdit->setReadOnly(readOnly);
     
-    // 验证器和范围
-    QString valid = getAttribute(element, "valid");
-    double minVal = getDoubleAttribute(element, "min", -1e308);
-    double maxVal = getDoubleAttribute(element, "max", 1e308);
-    bool required = getBoolAttribute(element, "required", false);
-    QString pattern = getAttribute(element, "pattern");
-    QString errorMsg = getAttribute(element, "errorMsg");
-    
-    // 不使用QValidator，允许用户自由输入，通过红框提示验证错误
+    // 验证规则（不使用QValidator，允许用户自由输入，通过红框提示验证错误）
+    ValidationRule rule = validationRule(element);
     
     // 存储验证参数和变量名到属性中
     QString varName = getAttribute(element, "var");
     lineEdit->setProperty("_Quik_varName", varName);
-    lineEdit->setProperty("_Quik_valid", valid);
-    lineEdit->setProperty("_Quik_min", minVal);
-    lineEdit->setProperty("_Quik_max", maxVal);
-    lineEdit->setProperty("_Quik_required", required);
-    lineEdit->setProperty("_Quik_pattern", pattern);
-    lineEdit->setProperty("_Quik_errorMsg", errorMsg);
+    lineEdit->setProperty("_Quik_valid", rule.valid);
+    lineEdit->setProperty("_Quik_min", rule.min);
+    lineEdit->setProperty("_Quik_max", rule.max);
+    lineEdit->setProperty("_Quik_required", rule.required);
+    lineEdit->setProperty("_Quik_pattern", rule.pattern.pattern());
+    lineEdit->setProperty("_Quik_errorMsg", rule.errorMsg);
     
     // 正常样式
     QString normalStyle = "QLineEdit { border: 1px solid #ccc; padding: 2px; }";
@@ -169,35 +161,9 @@ QWidget* WidgetFactory::createLineEdit(const QDomElement& element, QuikContext*
     lineEdit->setProperty("_Quik_normalStyle", normalStyle);
     lineEdit->setProperty("_Quik_errorStyle", errorStyle);
     
-    // 连接文本变化信号进行验证
-    QObject::connect(lineEdit, &QLineEdit::textChanged, [lineEdit, valid, minVal, maxVal, required, pattern, errorMsg, normalStyle, errorStyle]() {
-        QString text = lineEdit->text();
-        QString error;
-        
-        // 必填验证
-        if (required && text.isEmpty()) {
-            error = errorMsg.isEmpty() ? ValidationMessages::required() : errorMsg;
-        }
-        // 数值范围验证
-        else if (!text.isEmpty() && (valid == "double" || valid == "int")) {
-            bool ok;
-            double val = text.toDouble(&ok);
-            if (!ok) {
-                // 转换失败（数值过大或格式错误）- 始终使用内置提示
-                error = ValidationMessages::invalidNumber();
-            } else if (val < minVal) {
-                error = errorMsg.isEmpty() ? ValidationMessages::minValue(minVal) : errorMsg;
-            } else if (val > maxVal) {
-                error = errorMsg.isEmpty() ? ValidationMessages::maxValue(maxVal) : errorMsg;
-            }
-        }
-        // 正则验证
-        else if (!pattern.isEmpty() && !text.isEmpty()) {
-            QRegularExpression re(pattern);
-            if (!re.match(text).hasMatch()) {
-                error = errorMsg.isEmpty() ? ValidationMessages::invalidFormat() : errorMsg;
-            }
-        }
+    // 验证函数（规则与无界面模型共用）
+    auto validate = [lineEdit, rule, normalStyle, errorStyle]() {
+        QString error = rule.check(lineEdit->text());
         
         // 应用样式和提示
         if (!error.isEmpty()) {
@@ -209,7 +175,14 @@ QWidget* WidgetFactory::createLineEdit(const QDomElement& element, QuikContext*
             lineEdit->setToolTip("");
             lineEdit->setProperty("_Quik_hasError", false);
         }
-    });
+    };
+    
+    // commit="editingFinished" 时只在编辑完成后验证，否则随输入实时验证
+    if (getAttribute(element, "commit") == "editingFinished") {
+        QObject::connect(lineEdit, &QLineEdit::editingFinished, validate);
+    } else {
+        QObject::connect(lineEdit, &QLineEdit::textChanged, validate);
+    }
     
     // 对齐方式
     QString align = getAttribute(element, "align");
@@ -256,33 +229,16 @@ QWidget* WidgetFactory::createComboBox(const QDomElement& element, QuikContext*
             // 解析 q-for 格式：
             // 1. "item in listName"
             // 2. "(item, index) in listName"
-            QString itemVar, indexVar, listName;
-            
-            // 尝试匹配带索引的格式: (item, index) in listName
-            QRegularExpression reWithIndex("\\(\\s*(\\w+)\\s*,\\s*(\\w+)\\s*\\)\\s+in\\s+(\\w+)");
-            QRegularExpressionMatch matchWithIndex = reWithIndex.match(qFor);
+            QForExpression qForExpr = ExpressionParser::parseQFor(qFor);
             
-            if (matchWithIndex.hasMatch()) {
-                itemVar = matchWithIndex.captured(1);   // "item"
-                indexVar = matchWithIndex.captured(2);  // "index"
-                listName = matchWithIndex.captured(3);  // "listName"
-            } else {
-                // 尝试匹配简单格式: item in listName
-                QRegularExpression reSimple("(\\w+)\\s+in\\s+(\\w+)");
-                QRegularExpressionMatch matchSimple = reSimple.match(qFor);
-                if (matchSimple.hasMatch()) {
-                    itemVar = matchSimple.captured(1);
-                    listName = matchSimple.captured(2);
-                }
-            }
-            
-            if (!itemVar.isEmpty() && !listName.isEmpty()) {
+            if (qForExpr.isValid) {
                 // 获取模板属性
                 QString textTemplate = getAttribute(choice, "text");
                 QString valTemplate = getAttribute(choice, "val");
                 
                 // 注册 q-for 绑定（支持响应式更新）
-                context->registerQForBinding(comboBox, listName, itemVar, indexVar, textTemplate, valTemplate);
+                context->registerQForBinding(comboBox, qForExpr.listName, qForExpr.itemVar, qForExpr.indexVar,
+                                             textTemplate, valTemplate);
             }
         } else {
             // 普通 Choice 元素
@@ -592,7 +548,6 @@ QWidget* WidgetFactory::createListBox(const QDomElement& element, QuikContext* c
 QWidget* WidgetFactory::createTabBar(const QDomElement& element, QuikContext* context) {
     auto* tabBar = new QTabBar();
     
-    QString var = getAttribute(element, "var");
     QString defaultVal = getAttribute(element, "default");
     int defaultIndex = 0;
     
@@ -620,24 +575,7 @@ QWidget* WidgetFactory::createTabBar(const QDomElement& element, QuikContext* co
         tabBar->setCurrentIndex(defaultIndex);
     }
     
-    // 注册变量并连接信号
-    if (!var.isEmpty() && context) {
-        tabBar->setObjectName(var);
-        context->registerVariable(var, tabBar);
-        
-        // 初始化变量值
-        if (tabBar->count() > 0) {
-            QString initialVal = tabBar->tabData(defaultIndex).toString();
-            context->setValue(var, initialVal);
-        }
-        
-        // 连接信号
-        QObject::connect(tabBar, &QTabBar::currentChanged, [context, var, tabBar](int index) {
-            QString val = tabBar->tabData(index).toString();
-            context->setValue(var, val);
-        });
-    }
-    
+    // var 的注册和 currentChanged 信号连接由 QTabBar 适配器统一处理
     applyCommonAttributes(tabBar, element, context);
     return tabBar;
 }
@@ -800,11 +738,135 @@ QWidget* WidgetFactory::createTwoPointLineEdit(const QDomElement& element, QuikC
     return widget;
 }
 
+// ========== 无界面模型 ==========
+
+QVariantMap WidgetFactory::defaultValues(const QDomElement& element) {
+    QVariantMap values;
+    QString var = getAttribute(element, "var");
+    if (var.isEmpty()) {
+        return values;
+    }
+    
+    QString tagName = element.tagName();
+    if (tagName == "CheckBox" || tagName == "RadioButton") {
+        values[var] = getBoolAttribute(element, "default", false) ? 1 : 0;
+    } else if (tagName == "SpinBox" || tagName == "Slider" || tagName == "Dial" || tagName == "ProgressBar") {
+        values[var] = getIntAttribute(element, "default", getIntAttribute(element, "min", 0));
+    } else if (tagName == "DoubleSpinBox") {
+        values[var] = getDoubleAttribute(element, "default", getDoubleAttribute(element, "min", 0.0));
+    } else if (tagName == "ComboBox" || tagName == "TabBar" || tagName == "NewTabBar") {
+        // 与创建器一致：default 匹配 val，ComboBox 还支持数字索引，否则取第一项
+        bool isComboBox = tagName == "ComboBox";
+        QString defaultVal = getAttribute(element, "default");
+        QStringList choices;
+        for (QDomElement choice = element.firstChildElement("Choice"); !choice.isNull();
+             choice = choice.nextSiblingElement("Choice")) {
+            if (!getAttribute(choice, "q-for").isEmpty()) {
+                continue;
+            }
+            QString val = getAttribute(choice, "val");
+            choices.append(isComboBox && val.isEmpty() ? getAttribute(choice, "text") : val);
+        }
+        
+        if (choices.isEmpty()) {
+            if (!defaultVal.isEmpty()) {
+                values[var] = defaultVal;
+            }
+            return values;
+        }
+        
+        bool ok;
+        int numDefault = defaultVal.toInt(&ok);
+        if (isComboBox && ok && numDefault >= 0 && numDefault < choices.size()) {
+            values[var] = choices.at(numDefault);
+        } else if (!defaultVal.isEmpty() && choices.contains(defaultVal)) {
+            values[var] = defaultVal;
+        } else {
+            values[var] = choices.first();
+        }
+    } else if (tagName == "Label") {
+        QString title = getAttribute(element, "title");
+        values[var] = title.isEmpty() ? getAttribute(element, "text") : title;
+    } else if (tagName == "LineEdit" || tagName == "TextEdit" || tagName == "PlainTextEdit") {
+        values[var] = getAttribute(element, "default");
+    } else if (tagName == "DateTimeEdit") {
+        QString defaultVal = getAttribute(element, "default");
+        QDateTime dt = QDateTime::currentDateTime();
+        if (defaultVal != "now" && !defaultVal.isEmpty()) {
+            QDateTime parsed = QDateTime::fromString(defaultVal, getAttribute(element, "format", "yyyy/M/d HH:mm"));
+            if (parsed.isValid()) {
+                dt = parsed;
+            }
+        }
+        values[var] = dt.toString(Qt::ISODate);
+    } else if (tagName == "PointLineEdit") {
+        for (int i = 0; i < 3; ++i) {
+            values[var + "_" + QString::number(i)] = QStringLiteral("0");
+        }
+    } else if (tagName == "TwoPointLineEdit") {
+        for (int i = 0; i < 3; ++i) {
+            values[var + "_p1_" + QString::number(i)] = QStringLiteral("0");
+            values[var + "_p2_" + QString::number(i)] = QStringLiteral("0");
+        }
+    } else if (element.hasAttribute("default")) {
+        values[var] = getAttribute(element, "default");
+    }
+    
+    return values;
+}
+
+ValidationRule WidgetFactory::validationRule(const QDomElement& element) {
+    ValidationRule rule;
+    QString tagName = element.tagName();
+    
+    if (tagName == "SpinBox" || tagName == "DoubleSpinBox") {
+        rule.valid = tagName == "SpinBox" ? "int" : "double";
+        rule.min = getDoubleAttribute(element, "min", 0.0);
+        rule.max = getDoubleAttribute(element, "max", 100.0);
+        
+        // SpinBox 支持 max="+" 表示最大值
+        QString maxStr = getAttribute(element, "max");
+        if (tagName == "SpinBox" && (maxStr == "+" || maxStr == "max")) {
+            rule.max = INT_MAX;
+        }
+        return rule;
+    }
+    
+    if (tagName != "LineEdit") {
+        return rule;
+    }
+    
+    rule.valid = getAttribute(element, "valid");
+    rule.min = getDoubleAttribute(element, "min", -1e308);
+    rule.max = getDoubleAttribute(element, "max", 1e308);
+    rule.required = getBoolAttribute(element, "required", false);
+    rule.pattern.setPattern(getAttribute(element, "pattern"));
+    rule.errorMsg = getAttribute(element, "errorMsg");
+    return rule;
+}
+
 // ========== 辅助方法 ==========
 
 void WidgetFactory::applyCommonAttributes(QWidget* widget, const QDomElement& element, QuikContext* context) {
     if (!widget) return;
     
+    // 更新频率控制：debounce="ms" / throttle="ms" / commit="editingFinished"
+    // 须在注册变量之前暂存，由 QuikContext 自动连接时读取
+    int debounce = getIntAttribute(element, "debounce", 0);
+    if (debounce > 0) {
+        widget->setProperty("_Quik_debounce", debounce);
+    }
+    
+    int throttle = getIntAttribute(element, "throttle", 0);
+    if (throttle > 0) {
+        widget->setProperty("_Quik_throttle", throttle);
+    }
+    
+    QString commit = getAttribute(element, "commit");
+    if (!commit.isEmpty()) {
+        widget->setProperty("_Quik_commit", commit);
+    }
+    
     // 变量名（用于注册和绑定）
     QString var = getAttribute(element, "var");
     if (!var.isEmpty() && context) {
@@ -2,14 +2,17 @@
 #define WIDGETFACTORY_H
 
 #include "Quik/QuikAPI.h"
+#include "widget/WidgetAdapter.h"
 #include <QWidget>
 #include <QtXml/QDomElement>
 #include <QMap>
+#include <QVariantMap>
 #include <functional>
 
 namespace Quik {
 
 class QuikContext;
+struct ValidationRule;
 
 /**
  * @brief 组件创建函数类型
@@ -37,6 +40,25 @@ public:
      */
     void registerCreator(const QString& tagName, WidgetCreator creator);
     
+    /**
+     * @brief 注册组件创建器及其值适配器
+     * @param tagName XML标签名
+     * @param creator 创建函数
+     * @param metaObject 创建的组件类型（如 &MyWidget::staticMetaObject）
+     * @param adapter 值适配器，用于 var 双向绑定
+     * 
+     * 使用示例：
+     * @code
+     * Quik::WidgetAdapter adapter;
+     * adapter.read = [](QWidget* w) -> QVariant { return static_cast<ColorPicker*>(w)->color(); };
+     * adapter.write = [](QWidget* w, const QVariant& v) { static_cast<ColorPicker*>(w)->setColor(v.value<QColor>()); };
+     * WidgetFactory::instance().registerCreator("ColorPicker", createColorPicker,
+     *                                           &ColorPicker::staticMetaObject, adapter);
+     * @endcode
+     */
+    void registerCreator(const QString& tagName, WidgetCreator creator,
+                         const QMetaObject* metaObject, const WidgetAdapter& adapter);
+    
     /**
      * @brief 创建组件
      * @param tagName XML标签名
@@ -58,6 +80,26 @@ public:
      */
     void registerBuiltinWidgets();
     
+    // ========== 无界面模型 ==========
+    
+    /**
+     * @brief 不创建组件时各变量的初始值
+     * @param element XML元素
+     * @return 变量名到初始值的映射（PointLineEdit 等含多个子变量），没有 var 时为空
+     * 
+     * 与对应创建器设置的初始值一致，供 XMLUIBuilder::buildModel() 使用；
+     * 自定义组件只能取 default 属性。ComboBox 的 q-for 选项依赖数据源，此处不展开。
+     */
+    static QVariantMap defaultValues(const QDomElement& element);
+    
+    /**
+     * @brief 解析元素的校验规则
+     * 
+     * LineEdit 读取 valid/min/max/required/pattern/errorMsg；
+     * SpinBox/DoubleSpinBox 的 min/max 作为范围检查（界面上会被钳制，外部数据则报告为错误）。
+     */
+    static ValidationRule validationRule(const QDomElement& element);
+    
 private:
     WidgetFactory();
     ~WidgetFactory() = default;